@@ -1,17 +1,18 @@
 #include <string>
+#include <vector>
 #ifndef GAS_H
 #define GAS_H
 
 class WindGasInterface {
 public:
-  WindGasInterface(std::string path, std::string outpath="");
+  WindGasInterface(std::string source, std::string outpath="");
   void addFlag(std::string flag);
   std::string assemble();
 
 private:
-  std::string file_path;
+  std::string source;
   std::string outpath;
-  std::string flags;
+  std::vector<std::string> flags;
   int retcode;
 };
 
@@ -0,0 +1,46 @@
+#include <wind/backend/writer/format/object.h>
+#include <string>
+#include <vector>
+#include <map>
+#ifndef JIT_H
+#define JIT_H
+
+// Loads object images into executable memory of the running process and
+// resolves their externs against the libraries windc itself is linked to.
+class WindJit {
+public:
+  WindJit() {}
+  ~WindJit();
+  void addImage(ObjectImage &image);
+  bool addObject(std::string path);
+  void addLdFlag(std::string flag);
+  bool link();
+  int run(int argc, char **argv);
+  std::string getError() { return error; }
+
+private:
+  struct Placement {
+    size_t image;
+    size_t section;
+    uint64_t offset; // from the start of the mapping
+  };
+
+  bool fail(std::string message) { this->error = message; return false; }
+  void *resolveExtern(const std::string &name);
+  uint8_t *stubFor(const std::string &name, void *target);
+
+  std::vector<ObjectImage> images;
+  std::vector<std::string> lib_dirs;
+  std::vector<std::string> libs;
+  std::vector<void*> handles;
+  std::map<std::string, uint8_t*> globals;
+  std::map<std::string, uint8_t*> stubs;
+  uint8_t *memory = nullptr;
+  size_t memory_size = 0;
+  size_t code_size = 0;
+  size_t stub_offset = 0;
+  size_t stub_count = 0;
+  std::string error;
+};
+
+#endif
@@ -0,0 +1,83 @@
+#include <wind/backend/writer/arch/x86.h>
+#include <wind/backend/writer/format/object.h>
+#include <set>
+#ifndef WRITER_Bx86_64_H
+#define WRITER_Bx86_64_H
+
+// Binary counterpart of Ax86_64: the same instruction calls are encoded
+// straight into machine code and linked into an ObjectImage.
+class Bx86_64 : public Ax86_64 {
+private:
+    struct Encoding {
+        uint8_t prefix[3];
+        uint8_t n_prefix = 0;
+        uint8_t rex = 0;
+        bool force_rex = false;
+        uint8_t opcode[3];
+        uint8_t n_opcode = 0;
+        bool has_modrm = false;
+        uint8_t modrm = 0;
+        bool has_sib = false;
+        uint8_t sib = 0;
+        uint8_t disp_size = 0;
+        int32_t disp = 0;
+        uint8_t imm_size = 0;
+        int64_t imm = 0;
+        const std::string *label = nullptr; // symbolic displacement
+        int64_t label_offset = 0;
+        Fixup::Kind label_kind = Fixup::REL32;
+    };
+
+    bool unsupported = false;
+    std::set<std::string> globals;
+
+    Label &Current() { return content.sections[content.cs_id].labels[content.cl_id]; }
+    void Fail() { this->unsupported = true; }
+
+    bool OperandSize(Encoding &enc, uint16_t size);
+    void Opcode(Encoding &enc, uint8_t op) { enc.opcode[enc.n_opcode++] = op; }
+    bool RegField(Encoding &enc, Reg &reg);
+    bool RmReg(Encoding &enc, Reg &reg);
+    bool RmMem(Encoding &enc, Mem &mem);
+    void Ext(Encoding &enc, uint8_t ext) { enc.has_modrm = true; enc.modrm |= (ext & 7) << 3; }
+    bool Imm(Encoding &enc, int64_t imm, uint16_t size);
+    void Emit(Encoding &enc);
+
+    bool EncodeRmImm(const std::string &instr, Encoding &enc, uint16_t size, int64_t imm);
+    bool EncodeRmReg(const std::string &instr, Encoding &enc, uint16_t size, Reg &reg, bool reg_is_dst);
+
+public:
+    using Ax86_64::Write;
+    Bx86_64() {}
+
+    bool Unsupported() { return unsupported; }
+    bool Link(ObjectImage &image);
+
+    void Write(std::string content) override;
+    void Global(std::string name) override { this->globals.insert(name); }
+    void Extern(std::string) override {}
+    void Align(uint16_t size) override;
+
+    void Write(std::string instr, Reg dst, Reg src) override;
+    void Write(std::string instr, Reg dst, Mem src) override;
+    void Write(std::string instr, Mem dst, Reg src) override;
+    void Write(std::string instr, Mem dst, int64_t imm) override;
+    void Write(std::string instr, Reg dst, int64_t imm) override;
+    void Write(std::string instr, int64_t imm, Reg src) override;
+    void Write(std::string instr, int64_t imm, Mem src) override;
+    void Write(std::string instr, Reg dst) override;
+    void Write(std::string instr, Mem dst) override;
+    void Write(std::string instr, std::string label) override;
+    void Write(std::string instr, int64_t imm) override;
+    void Write(std::string, Reg, RegOffset) override { this->Fail(); }
+    void Write(std::string, Mem, Mem) override { this->Fail(); }
+
+    void String(std::string content) override;
+    void Byte(long value) override;
+    void Word(long value) override;
+    void Dword(long value) override;
+    void Qword(long value) override;
+    void Reserve(long size) override;
+};
+
+#endif
\ No newline at end of file
@@ -45,9 +45,25 @@ public:
     Mem(Reg base, Reg index, int64_t offset, uint16_t size) : base(base), index(index), offset(offset), size(size) { base_type = BASE; offset_type = REG_IMM; }
 };
 
+struct Fixup {
+    uint32_t offset; // offset of the field inside the label code
+    std::string target;
+    int64_t addend;
+    enum Kind {
+        REL32,      // rip relative operand
+        BRANCH32,   // call displacement
+        JUMP32,     // jmp/jcc displacement, may be relaxed to 8 bits
+        ABS32S      // sign extended absolute address
+    } kind;
+};
+
 struct Label {
     std::string name;
     std::string content;
+    // Filled by binary writers only
+    std::vector<uint8_t> code;
+    std::vector<Fixup> fixups;
+    std::vector<std::pair<uint32_t, uint16_t>> aligns; // (offset, alignment)
 };
 struct Section {
     std::string name;
@@ -56,6 +72,7 @@ struct Section {
 };
 
 class WindWriter {
+protected:
     class Content {
     public:
         std::vector<Section> sections;
@@ -82,36 +99,36 @@ public:
     // Label management
     uint16_t NewLabel(std::string name) { return content.NewLabel(name); }
     void BindLabel(uint16_t id) { content.BindLabel(id); }
-    void Write(std::string content) { this->content.WriteLabel(content + "\n"); }
+    virtual void Write(std::string content) { this->content.WriteLabel(content + "\n"); }
     std::string LabelById(uint16_t id) { return content.LabelById(id); }
 
-    void Global(std::string name) { this->WriteHdr(".global " + name); }
-    void Extern(std::string name) { this->WriteHdr(".extern " + name); }
-    void Align(uint16_t size) { this->Write(".align " + std::to_string(size)); }
+    virtual void Global(std::string name) { this->WriteHdr(".global " + name); }
+    virtual void Extern(std::string name) { this->WriteHdr(".extern " + name); }
+    virtual void Align(uint16_t size) { this->Write(".align " + std::to_string(size)); }
 
     virtual std::string ResolveReg(Reg &reg) { return ""; }
     virtual std::string ResolveMem(Mem &mem) { return ""; }
     virtual std::string ResolveRegOff(RegOffset &offs) { return ""; }
     virtual std::string ResolveWord(uint16_t size) { return ""; }
 
-    void Write(std::string instr, Reg dst, Reg src) { this->Write(instr + " " + ResolveReg(dst) + ", " + ResolveReg(src)); }
-    void Write(std::string instr, Reg dst, Mem src) { this->Write(instr + " " + ResolveReg(dst) + ", " + ResolveMem(src)); }
-    void Write(std::string instr, Mem dst, Reg src) { this->Write(instr + " " + ResolveMem(dst) + ", " + ResolveReg(src)); }
-    void Write(std::string instr, Mem dst, int64_t imm) { this->Write(instr + " " + ResolveMem(dst) + ", " + std::to_string(imm)); }
-    void Write(std::string instr, Reg dst, int64_t imm) { this->Write(instr + " " + ResolveReg(dst) + ", " + std::to_string(imm)); }
+    virtual void Write(std::string instr, Reg dst, Reg src) { this->Write(instr + " " + ResolveReg(dst) + ", " + ResolveReg(src)); }
+    virtual void Write(std::string instr, Reg dst, Mem src) { this->Write(instr + " " + ResolveReg(dst) + ", " + ResolveMem(src)); }
+    virtual void Write(std::string instr, Mem dst, Reg src) { this->Write(instr + " " + ResolveMem(dst) + ", " + ResolveReg(src)); }
+    virtual void Write(std::string instr, Mem dst, int64_t imm) { this->Write(instr + " " + ResolveMem(dst) + ", " + std::to_string(imm)); }
+    virtual void Write(std::string instr, Reg dst, int64_t imm) { this->Write(instr + " " + ResolveReg(dst) + ", " + std::to_string(imm)); }
 
-    void Write(std::string instr, int64_t imm, Reg src) { this->Write(instr + " " + std::to_string(imm) + ", " + ResolveReg(src)); }
-    void Write(std::string instr, int64_t imm, Mem src) { this->Write(instr + " " + std::to_string(imm) + ", " + ResolveMem(src)); }
+    virtual void Write(std::string instr, int64_t imm, Reg src) { this->Write(instr + " " + std::to_string(imm) + ", " + ResolveReg(src)); }
+    virtual void Write(std::string instr, int64_t imm, Mem src) { this->Write(instr + " " + std::to_string(imm) + ", " + ResolveMem(src)); }
 
-    void Write(std::string instr, Reg dst) { this->Write(instr + " " + ResolveReg(dst)); }
-    void Write(std::string instr, Mem dst) { this->Write(instr + " " + ResolveMem(dst)); }
-    void Write(std::string instr, std::string label) { this->Write(instr + " " + label); }
+    virtual void Write(std::string instr, Reg dst) { this->Write(instr + " " + ResolveReg(dst)); }
+    virtual void Write(std::string instr, Mem dst) { this->Write(instr + " " + ResolveMem(dst)); }
+    virtual void Write(std::string instr, std::string label) { this->Write(instr + " " + label); }
 
-    void Write(std::string instr, int64_t imm) { this->Write(instr + " " + std::to_string(imm)); }
+    virtual void Write(std::string instr, int64_t imm) { this->Write(instr + " " + std::to_string(imm)); }
 
-    void Write(std::string instr, Reg src, RegOffset offs) { this->Write(instr + " " + ResolveReg(src) + ", " + ResolveRegOff(offs)); }
+    virtual void Write(std::string instr, Reg src, RegOffset offs) { this->Write(instr + " " + ResolveReg(src) + ", " + ResolveRegOff(offs)); }
 
-    void Write(std::string instr, Mem dst, Mem src) { this->Write(instr + " " + ResolveMem(dst) + ", " + ResolveMem(src)); }
+    virtual void Write(std::string instr, Mem dst, Mem src) { this->Write(instr + " " + ResolveMem(dst) + ", " + ResolveMem(src)); }
 
     // Memory
     Mem ptr(Reg base, int64_t offset, uint16_t size) { return Mem(base, offset, size); }
@@ -123,15 +140,17 @@ public:
     RegOffset roff(Reg reg, int64_t offset) { return {reg, offset}; }
 
     // Data
-    void String(std::string content) { this->Write(".string \"" + content + "\""); }
-    void Byte(long value) { this->Write(".byte " + std::to_string(value)); }
-    void Word(long value) { this->Write(".short " + std::to_string(value)); }
-    void Dword(long value) { this->Write(".long " + std::to_string(value)); }
-    void Qword(long value) { this->Write(".quad " + std::to_string(value)); }
-    void Reserve(long size) { this->Write(".space " + std::to_string(size)); }
+    virtual void String(std::string content) { this->Write(".string \"" + content + "\""); }
+    virtual void Byte(long value) { this->Write(".byte " + std::to_string(value)); }
+    virtual void Word(long value) { this->Write(".short " + std::to_string(value)); }
+    virtual void Dword(long value) { this->Write(".long " + std::to_string(value)); }
+    virtual void Qword(long value) { this->Write(".quad " + std::to_string(value)); }
+    virtual void Reserve(long size) { this->Write(".space " + std::to_string(size)); }
 
     // Emission
     std::string Emit();
+
+    virtual ~WindWriter() {}
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,27 @@
+#include <wind/backend/writer/format/object.h>
+#include <string>
+#ifndef WRITER_ELF_H
+#define WRITER_ELF_H
+
+class WindElfWriter {
+public:
+    WindElfWriter(ObjectImage &image) : image(image) {}
+    std::string Emit();
+    bool Write(std::string path);
+
+private:
+    ObjectImage &image;
+};
+
+// Loads an ELF64 relocatable object back into an image (e.g. for the JIT)
+class WindElfReader {
+public:
+    WindElfReader(ObjectImage &image) : image(image) {}
+    bool Parse(const std::string &content);
+    bool Read(std::string path);
+
+private:
+    ObjectImage &image;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,40 @@
+#include <string>
+#include <stdint.h>
+#include <vector>
+
+#ifndef WRITER_OBJECT_H
+#define WRITER_OBJECT_H
+
+// Linked output of a binary writer, independent of the container format
+
+struct ObjectSection {
+    std::string name;
+    std::vector<uint8_t> data;
+    uint64_t align = 1;
+    bool write = false;
+    bool exec = false;
+};
+
+struct ObjectSymbol {
+    std::string name;
+    int32_t section;   // -1 when undefined
+    uint64_t value;
+    bool global;
+    bool is_section;
+};
+
+struct ObjectReloc {
+    uint16_t section;  // section the relocation applies to
+    uint64_t offset;
+    uint32_t type;     // R_X86_64_*
+    uint32_t symbol;   // index into ObjectImage::symbols
+    int64_t addend;
+};
+
+struct ObjectImage {
+    std::vector<ObjectSection> sections;
+    std::vector<ObjectSymbol> symbols;
+    std::vector<ObjectReloc> relocs;
+};
+
+#endif
\ No newline at end of file
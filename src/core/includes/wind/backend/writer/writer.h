@@ -3,5 +3,6 @@
 
 #include <wind/backend/writer/common/manage.h>
 #include <wind/backend/writer/arch/x86.h>
+#include <wind/backend/writer/arch/x86_bin.h>
 
 #endif
\ No newline at end of file
@@ -24,6 +24,7 @@ class WindEmitter {
 private:
     IRBody *program;
     Ax86_64 *writer;
+    bool binary;
 
     // ----
 
@@ -79,7 +80,8 @@ private:
     } regalloc;
 
 public:
-    WindEmitter(IRBody *program): program(program), writer(new Ax86_64()) {
+    WindEmitter(IRBody *program, bool binary=false): program(program), binary(binary) {
+        this->writer = binary ? new Bx86_64() : new Ax86_64();
         jmp_map[IRBinOp::Operation::EQ][0][0] = [this](uint16_t label) { this->writer->je(this->writer->LabelById(label)); };
         jmp_map[IRBinOp::Operation::EQ][0][1] = [this](uint16_t label) { this->writer->jne(this->writer->LabelById(label)); };
         jmp_map[IRBinOp::Operation::EQ][1][0] = [this](uint16_t label) { this->writer->je(this->writer->LabelById(label)); };
@@ -104,6 +106,7 @@ public:
     void Process();
     std::string GetAsm() { return writer->Emit(); }
     std::string emitObj(std::string outpath="");
+    bool emitImage(ObjectImage &image);
 
 private:
     void EmitFnPrologue(IRFunction *fn);
@@ -163,6 +166,7 @@ private:
         };
         std::map<std::string, UserHandlerDesc> active_handlers;
         std::vector<UserHandlerDesc> user_handlers;
+        std::map<std::string, std::string> handler_labels;
     } *current_fn=nullptr;
 
     const char *GetHandlerLabel(std::string instruction) {
@@ -171,7 +175,10 @@ private:
         }
         if (current_fn->base_handlers.find(instruction) != current_fn->base_handlers.end()) {
             current_fn->base_handlers[instruction].needEmit = true;
-            static std::string handler_str = HANDLER_LABEL(current_fn->fn->fn_name, instruction);
+            std::string &handler_str = current_fn->handler_labels[instruction];
+            if (handler_str.empty()) {
+                handler_str = HANDLER_LABEL(current_fn->fn->fn_name, instruction);
+            }
             return handler_str.c_str();
         }
         return "";
@@ -0,0 +1,49 @@
+#include <stddef.h>
+#include <vector>
+
+#ifndef AST_ARENA_H
+#define AST_ARENA_H
+
+class ASTNode;
+
+// Bump allocator owning the AST nodes of a translation unit. While a Scope
+// is active, every ASTNode created by the thread is placed in the arena;
+// links between nodes don't own them (see ASTPtr), so shared subtrees are
+// fine. Destroying the arena runs the destructors of its nodes once and
+// frees all the blocks at once.
+class ASTArena {
+public:
+  ASTArena() = default;
+  ~ASTArena();
+  ASTArena(const ASTArena&) = delete;
+  ASTArena& operator=(const ASTArena&) = delete;
+
+  // Takes over the nodes of another arena, which is deleted
+  void adopt(ASTArena *other);
+  // Bytes taken by the nodes so far
+  size_t used() const;
+  static ASTArena *Current();
+
+  class Scope {
+  public:
+    Scope(ASTArena *arena);
+    ~Scope();
+
+  private:
+    ASTArena *previous;
+  };
+
+private:
+  friend class ASTNode;
+
+  struct Block {
+    char *data;
+    size_t size;
+    size_t used;
+  };
+  std::vector<Block> blocks;
+
+  void *allocate(size_t size);
+};
+
+#endif
@@ -6,6 +6,7 @@
 #include <vector>
 #include <map>
 #include <wind/bridge/flags.h>
+#include <wind/bridge/type.h>
 
 class ASTVisitor;
 
@@ -13,15 +14,27 @@ class ASTNode {
 public:
   virtual ~ASTNode() = default;
   virtual void *accept(ASTVisitor &visitor) const = 0;
+
+  // Nodes are placed in the thread's ASTArena when one is active
+  static void *operator new(size_t size);
+  static void operator delete(void *ptr);
+};
+
+// Links between nodes don't own them: the AST shares subtrees (desugared
+// operators, merged modules), nodes are released with their ASTArena
+struct ASTDeleter {
+  void operator()(ASTNode *) const {}
 };
+template <typename T>
+using ASTPtr = std::unique_ptr<T, ASTDeleter>;
 
 class BinaryExpr : public ASTNode {
-  std::unique_ptr<ASTNode> left;
-  std::unique_ptr<ASTNode> right;
+  ASTPtr<ASTNode> left;
+  ASTPtr<ASTNode> right;
   std::string op;
 
 public:
-  BinaryExpr(std::unique_ptr<ASTNode> l, std::unique_ptr<ASTNode> r, std::string o);
+  BinaryExpr(ASTPtr<ASTNode> l, ASTPtr<ASTNode> r, std::string o);
 
   void *accept(ASTVisitor &visitor) const override;
 
@@ -70,10 +83,10 @@ public:
 };
 
 class Return : public ASTNode {
-  std::unique_ptr<ASTNode> value;
+  ASTPtr<ASTNode> value;
 
 public:
-  explicit Return(std::unique_ptr<ASTNode> v);
+  explicit Return(ASTPtr<ASTNode> v);
 
   void *accept(ASTVisitor &visitor) const override;
 
@@ -82,12 +95,12 @@ public:
 };
 
 class Body : public ASTNode {
-  std::vector<std::unique_ptr<ASTNode>> statements;
+  std::vector<ASTPtr<ASTNode>> statements;
 
 public:
   std::map<std::string, ASTNode*> consts_table;
 
-  explicit Body(std::vector<std::unique_ptr<ASTNode>> s);
+  explicit Body(std::vector<ASTPtr<ASTNode>> s);
 
   Body(const Body&) = delete;
   Body& operator=(const Body&) = delete;
@@ -97,20 +110,21 @@ public:
 
   void *accept(ASTVisitor &visitor) const override;
 
-  const std::vector<std::unique_ptr<ASTNode>>& get() const;
-  Body& operator + (std::unique_ptr<ASTNode> statement);
-  Body& operator += (std::unique_ptr<ASTNode> statement);
+  const std::vector<ASTPtr<ASTNode>>& get() const;
+  std::vector<ASTPtr<ASTNode>> take();
+  Body& operator + (ASTPtr<ASTNode> statement);
+  Body& operator += (ASTPtr<ASTNode> statement);
   Body& operator + (Body&) = delete;
 };
 
 class Function : public ASTNode {
   std::string fn_name;
-  std::string return_type;
-  std::unique_ptr<Body> body;
-  std::vector<std::string> arg_types;
+  const TypeExpr *return_type;
+  ASTPtr<Body> body;
+  std::vector<const TypeExpr*> arg_types;
 
 public:
-  Function(std::string name, std::string type, std::unique_ptr<Body> b);
+  Function(std::string name, const TypeExpr *type, ASTPtr<Body> b);
   std::string metadata="";
   bool isDefined = true;
 
@@ -119,71 +133,71 @@ public:
   // Getter
   const std::string& getName() const;
   const Body* getBody() const;
-  const std::string& getType() const;
-  void copyArgTypes(std::vector<std::string> &types);
-  std::vector<std::string> getArgTypes() const;
+  const TypeExpr *getType() const;
+  void copyArgTypes(std::vector<const TypeExpr*> &types);
+  const std::vector<const TypeExpr*> &getArgTypes() const;
 
   FnFlags flags;
 };
 
 class VariableDecl : public ASTNode {
   std::vector<std::string> vars;
-  std::string type; // Will resolve on IR generation
-  std::unique_ptr<ASTNode> value;
+  const TypeExpr *type; // Will resolve on IR generation
+  ASTPtr<ASTNode> value;
 
 public:
-  VariableDecl(std::vector<std::string> n, std::string t, std::unique_ptr<ASTNode> v = nullptr);
+  VariableDecl(std::vector<std::string> n, const TypeExpr *t, ASTPtr<ASTNode> v = nullptr);
 
   void *accept(ASTVisitor &visitor) const override;
 
   // Getters
   const std::vector<std::string>& getNames() const;
-  const std::string& getType() const;
+  const TypeExpr *getType() const;
   ASTNode *getValue() const;
 };
 
 class GlobalDecl : public ASTNode {
   std::string name;
-  std::string type; // Will resolve on IR generation
-  std::unique_ptr<ASTNode> value;
+  const TypeExpr *type; // Will resolve on IR generation
+  ASTPtr<ASTNode> value;
 
 public:
-  GlobalDecl(std::string n, std::string t, std::unique_ptr<ASTNode> v = nullptr);
+  GlobalDecl(std::string n, const TypeExpr *t, ASTPtr<ASTNode> v = nullptr);
 
   void *accept(ASTVisitor &visitor) const override;
 
   // Getters
   const std::string& getName() const;
-  const std::string& getType() const;
+  const TypeExpr *getType() const;
   ASTNode *getValue() const;
 };
 
 class ArgDecl : public ASTNode {
   std::string name;
-  std::string type; // Will resolve on IR generation
+  const TypeExpr *type; // Will resolve on IR generation
 
 public:
-  ArgDecl(std::string n, std::string t);
+  ArgDecl(std::string n, const TypeExpr *t);
 
   void *accept(ASTVisitor &visitor) const override;
 
   // Getters
   const std::string& getName() const;
-  const std::string& getType() const;
+  const TypeExpr *getType() const;
 };
 
 class FnCall : public ASTNode {
   std::string name;
 
 public:
-  std::vector<std::unique_ptr<ASTNode>> args;
-  FnCall(std::string n, std::vector<std::unique_ptr<ASTNode>> a);
+  std::vector<ASTPtr<ASTNode>> args;
+  FnCall(std::string n, std::vector<ASTPtr<ASTNode>> a);
 
   void *accept(ASTVisitor &visitor) const override;
 
   // Getters
   const std::string& getName() const;
-  const std::vector<std::unique_ptr<ASTNode>>& getArgs() const;
+  const std::vector<ASTPtr<ASTNode>>& getArgs() const;
 };
 
 class InlineAsm : public ASTNode {
@@ -207,18 +221,18 @@ private:
 
 class TypeDecl : public ASTNode {
   std::string name;
-  std::string type;
+  const TypeExpr *type;
 
 public:
-  TypeDecl(std::string n, std::string t);
+  TypeDecl(std::string n, const TypeExpr *t);
   void *accept(ASTVisitor &visitor) const;
   const std::string& getName() const;
-  const std::string& getType() const;
+  const TypeExpr *getType() const;
 };
 
 struct Branch {
-  std::unique_ptr<ASTNode> condition;
-  std::unique_ptr<Body> body;
+  ASTPtr<ASTNode> condition;
+  ASTPtr<Body> body;
 };
 
 class Branching : public ASTNode {
@@ -230,7 +244,7 @@ public:
   const std::vector<Branch>& getBranches() const;
   const Body *getElseBranch() const;
   void setElseBranch(Body* body);
-  void addBranch(std::unique_ptr<ASTNode> condition, std::unique_ptr<Body> body);
+  void addBranch(ASTPtr<ASTNode> condition, ASTPtr<Body> body);
 };
 
 class Looping : public ASTNode {
@@ -258,42 +272,42 @@ public:
 };
 
 class GenericIndexing : public ASTNode {
-  std::unique_ptr<ASTNode> index;
-  std::unique_ptr<ASTNode> base;
+  ASTPtr<ASTNode> index;
+  ASTPtr<ASTNode> base;
 
 public:
-  GenericIndexing(std::unique_ptr<ASTNode> i, std::unique_ptr<ASTNode> b);
+  GenericIndexing(ASTPtr<ASTNode> i, ASTPtr<ASTNode> b);
   void *accept(ASTVisitor &visitor) const;
   const ASTNode* getIndex() const;
   const ASTNode* getBase() const;
 };
 
 class PtrGuard : public ASTNode {
-  std::unique_ptr<ASTNode> value;
+  ASTPtr<ASTNode> value;
 
 public:
-  PtrGuard(std::unique_ptr<ASTNode> v);
+  PtrGuard(ASTPtr<ASTNode> v);
   void *accept(ASTVisitor &visitor) const;
   const ASTNode* getValue() const;
 };
 
 class TypeCast : public ASTNode {
-  std::string type;
-  std::unique_ptr<ASTNode> value;
+  const TypeExpr *type;
+  ASTPtr<ASTNode> value;
 public:
-  TypeCast(std::string t, std::unique_ptr<ASTNode> v);
+  TypeCast(const TypeExpr *t, ASTPtr<ASTNode> v);
   void *accept(ASTVisitor &visitor) const;
-  const std::string& getType() const;
+  const TypeExpr *getType() const;
   const ASTNode* getValue() const;
 };
 
 class SizeOf : public ASTNode {
-  std::string type;
+  const TypeExpr *type;
 
 public:
-  SizeOf(std::string t);
+  SizeOf(const TypeExpr *t);
   void *accept(ASTVisitor &visitor) const;
-  const std::string& getType() const;
+  const TypeExpr *getType() const;
 };
 
 class TryCatch : public ASTNode {
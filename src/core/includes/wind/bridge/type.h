@@ -0,0 +1,37 @@
+#include <stdint.h>
+#include <string>
+
+#ifndef AST_TYPE_H
+#define AST_TYPE_H
+
+// A type as written in the source: a name (`int`, `unsigned long`, a user
+// type), `ptr<T>` or `[T;N]`. The parser builds it once through TypeTable,
+// which interns every expression, so equal types are the same pointer and
+// the compiler memoizes their resolution by address.
+struct TypeExpr {
+  enum Kind {
+    NAMED,
+    POINTER,
+    ARRAY
+  };
+
+  Kind kind;
+  std::string spelling; // NAMED: the words as written
+  std::string name; // NAMED: without `unsigned`, the key of user types
+  bool is_unsigned = false;
+  const TypeExpr *inner = nullptr; // POINTER, ARRAY
+  uint32_t capacity = 0; // ARRAY, 0 when unsized
+
+  std::string str() const;
+};
+
+// Process-wide, thread-safe and never freed: types outlive every AST, warm
+// interfaces included
+class TypeTable {
+public:
+  static const TypeExpr *Named(const std::string &spelling);
+  static const TypeExpr *Pointer(const TypeExpr *inner);
+  static const TypeExpr *Array(const TypeExpr *inner, uint32_t capacity);
+};
+
+#endif
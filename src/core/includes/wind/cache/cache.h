@@ -0,0 +1,42 @@
+#include <string>
+#include <string_view>
+#include <vector>
+#include <stdint.h>
+
+#ifndef OBJECT_CACHE_H
+#define OBJECT_CACHE_H
+
+// What a cached compilation left behind besides the object itself
+struct CacheEntry {
+  std::string object;
+  std::vector<std::string> ld_flags;
+  std::vector<std::string> imports;
+};
+
+class WindObjectCache {
+public:
+  WindObjectCache(std::string dir);
+
+  std::string key(const std::string &path, uint32_t flags);
+  bool lookup(const std::string &key, CacheEntry &entry);
+  void store(
+    const std::string &key,
+    const std::string &object,
+    const std::vector<std::string> &deps,
+    const std::vector<std::string> &ld_flags,
+    const std::vector<std::string> &imports
+  );
+
+  std::string interfaceImage(const std::string &path);
+
+  static std::string defaultDir();
+
+private:
+  std::string dir;
+  std::string compiler_id;
+};
+
+std::string hashContent(std::string_view data);
+std::string hashFile(const std::string &path);
+
+#endif
@@ -0,0 +1,20 @@
+#include <functional>
+#include <string>
+#include <stdint.h>
+#include <wind/isc/isc.h>
+
+#ifndef INTERFACE_IMAGE_H
+#define INTERFACE_IMAGE_H
+
+// Resolves a nested interface of an image, nullptr if its source changed
+// since the image was written
+typedef std::function<InterfaceDesc*(const std::string &path, int64_t mtime)> NestedResolver;
+
+// A parsed interface serialized to a .wic image: declarations, constants,
+// link flags and imports, so later compiles skip lexing and parsing it.
+// Only declarations are encoded, interfaces defining functions are never
+// written.
+bool WriteInterfaceImage(const std::string &file, const InterfaceDesc *iface);
+bool ReadInterfaceImage(const std::string &file, InterfaceDesc *iface, const NestedResolver &resolve);
+
+#endif
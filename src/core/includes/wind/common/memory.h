@@ -0,0 +1,18 @@
+#include <ostream>
+#include <stdint.h>
+
+#ifndef WIND_COMMON_MEMORY_H
+#define WIND_COMMON_MEMORY_H
+
+// Allocation accounting (-fmem-report). Every operator new is charged to
+// the phase of the innermost WindTimer of the calling thread.
+
+void EnableMemoryReport();
+bool MemoryReportEnabled();
+int MemoryPhaseId(const char *phase);
+int EnterMemoryPhase(int id);
+void LeaveMemoryPhase(int id, int previous);
+void MemoryPhaseUsage(int id, uint64_t &count, uint64_t &bytes);
+void PrintMemoryReport(std::ostream &out);
+
+#endif
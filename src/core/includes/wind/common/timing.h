@@ -0,0 +1,36 @@
+#include <string>
+#include <ostream>
+#include <stdint.h>
+
+#ifndef WIND_COMMON_TIMING_H
+#define WIND_COMMON_TIMING_H
+
+// Scoped span of a compile phase. Spans nest per thread; reports use the
+// self time of a span (its children excluded), traces keep the nesting.
+// Spans also select the phase allocations are charged to (see memory.h).
+// Costs nothing unless EnableTimeTrace() or EnableMemoryReport() was called.
+class WindTimer {
+public:
+  WindTimer(const char *phase, std::string file="");
+  ~WindTimer();
+
+private:
+  bool active;
+  bool timed;
+  int mem_phase;
+  int mem_previous;
+  const char *phase;
+  std::string file;
+  uint64_t start_wall;
+  uint64_t start_cpu;
+  uint64_t child_wall = 0;
+  uint64_t child_cpu = 0;
+  WindTimer *parent;
+};
+
+void EnableTimeTrace();
+bool TimeTraceEnabled();
+void PrintTimeReport(std::ostream &out);
+bool WriteTimeTrace(std::string path);
+
+#endif
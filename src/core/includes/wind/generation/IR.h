@@ -32,7 +32,7 @@ const std::unordered_map<std::string, HandlerType> handler_map = {
 class DataType {
   private:
     DataType *array;
-    DataType *ptr;
+    DataType *ptr = nullptr;
     uint16_t type_size;
     uint16_t capacity;
     bool signed_type = true;
@@ -1,4 +1,5 @@
 #include <map>
+#include <unordered_map>
 #include <string>
 #include <vector>
 
@@ -20,12 +21,13 @@ private:
   IRBody *emission;
   IRFunction *current_fn;
   std::map<std::string, DataType*> userdef_types_map;
+  std::unordered_map<const TypeExpr*, DataType*> resolved_types;
   std::map<std::string, IRGlobRef*> global_table;
   std::map<std::string, IRFunction*> fn_table;
   bool decl_return = false;
 
   void compile();
-  DataType *ResolveDataType(const std::string &type);
+  DataType *ResolveDataType(const TypeExpr *type);
   void CanCoerce(IRNode *left, IRNode *right);
 
   // Visitor
@@ -0,0 +1,26 @@
+#include <string>
+#include <string_view>
+#include <deque>
+#include <unordered_map>
+#include <wind/processing/token.h>
+
+#ifndef INTERNER_H
+#define INTERNER_H
+
+// Token values shared by every source of an ISC context. Keywords get the
+// ids of the Keyword enum, symbol spellings follow in SymbolTable order.
+class WindInterner {
+public:
+  WindInterner();
+  TokenSymbol intern(std::string_view text);
+  const std::string &get(TokenSymbol symbol) const { return this->strings[symbol]; }
+  size_t size() const { return this->strings.size(); }
+
+  static TokenSymbol symbolOf(size_t table_index) { return KW_COUNT + table_index; }
+
+private:
+  std::deque<std::string> strings; // never moves, the index points into it
+  std::unordered_map<std::string_view, TokenSymbol> index;
+};
+
+#endif
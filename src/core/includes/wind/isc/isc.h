@@ -1,10 +1,13 @@
 #include <vector>
 #include <string>
 #include <wind/processing/lexer.h>
+#include <wind/processing/source.h>
+#include <wind/isc/interner.h>
 #include <wind/processing/token.h>
 #include <wind/reporter/parser.h>
 #include <wind/bridge/ast.h>
 #include <map>
+#include <unordered_map>
 #include <algorithm>
 
 #ifndef INTER_SOURCE_COMMUNICATION_H
@@ -12,30 +15,66 @@
 
 struct SourceDesc {
   std::string path;
+  SourceBuffer *source;
   TokenStream *stream;
   ParserReport *parser_report;
 };
 
+class ASTArena;
+class WindObjectCache;
+struct InterfaceDesc;
+
+// An include of another interface, spliced in when the interface is applied
+struct NestedInterface {
+  size_t at; // number of own statements before it
+  InterfaceDesc *iface;
+  bool once; // skipped if already included, imports always apply
+};
+
+// An interface parsed once per process. Its AST is shared by every unit
+// including it, so neither the statements nor the nodes are ever modified.
+struct InterfaceDesc {
+  std::string path;
+  int64_t mtime;
+  ASTArena *arena; // lives as long as the process, like the AST
+  Body *ast; // own statements only, nested interfaces are not merged in
+  std::vector<NestedInterface> nested;
+  std::vector<std::string> imports;
+  std::vector<std::string> ld_flags;
+};
+
 class WindISC {
 public:
   WindISC();
-  void tabulaRasa() { this->sources.clear(); }
+  void tabulaRasa() {
+    this->sources.clear(); this->src_ids.clear(); this->ld_user_flags.clear(); this->imp_toprocess.clear();
+    this->pending = nullptr;
+  }
   uint16_t getNewSrcId() { return this->sources.size(); }
   void setPath(uint16_t id, std::string path);
-  std::string getPath(uint16_t id);
+  std::string getPath(uint16_t id) const;
+  std::vector<std::string> getPaths() const;
+  void setSource(uint16_t id, SourceBuffer *source);
+  SourceBuffer *getSource(uint16_t id) const;
   void setStream(uint16_t id, TokenStream *stream);
-  void newParserReport(uint16_t id, std::string src);
-  int16_t getSrcId(std::string path);
-  TokenStream *getStream(uint16_t id);
-  ParserReport *getParserReport(uint16_t id);
+  void newParserReport(uint16_t id, const SourceBuffer *source);
+  int16_t getSrcId(std::string path) const;
+  TokenStream *getStream(uint16_t id) const;
+  ParserReport *getParserReport(uint16_t id) const;
+  WindInterner &getSymbols() { return this->symbols; }
 
   int workOnInclude(std::string path);
   int workOnImport(std::string path);
 
   Body *commitAST(Body *ast);
+  void setBuilding(InterfaceDesc *iface) { this->building = iface; }
 
   std::vector<std::string> getImports() { return this->imp_toprocess; }
-  void popImport() { this->imp_toprocess.pop_back(); }
+  std::vector<std::string> takeImports() {
+    std::vector<std::string> imports;
+    imports.swap(this->imp_toprocess);
+    return imports;
+  }
   
   void addLdFlag(std::string flag) {
     if (std::find(this->ld_user_flags.begin(), this->ld_user_flags.end(), flag) != this->ld_user_flags.end()) {
@@ -47,13 +86,30 @@ public:
   
 private:
   std::map<int, SourceDesc> sources;
-  Body *volatile_ast;
+  // First source id of every path, includes look them up on every unit
+  std::unordered_map<std::string, uint16_t> src_ids;
+  WindInterner symbols;
+  // Included by the last workOnInclude, taken by commitAST
+  InterfaceDesc *pending;
+  bool pending_once;
+  // The interface this ISC parses for the cache, if any
+  InterfaceDesc *building;
+
+  void applyInterface(const InterfaceDesc *iface, bool once, Body *into);
   std::vector<std::string> imp_toprocess;
   std::vector<std::string> ld_user_flags;
 };
 
-extern WindISC *global_isc;
+// Each compiling thread owns its own ISC context (see InitISC)
+extern thread_local WindISC *global_isc;
 
 void InitISC();
 
+// Parses an interface ahead of time so later compiles in this process (or
+// in processes forked from it) find it in the interface cache
+bool WarmInterface(std::string path);
+
+// Keeps precompiled interface images in the cache, nullptr to stop
+void UseInterfaceImages(WindObjectCache *cache);
+
 #endif
\ No newline at end of file
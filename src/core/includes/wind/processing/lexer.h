@@ -1,4 +1,5 @@
 #include <string>
+#include <string_view>
 #include <memory>
 #include <vector>
 #ifndef LEXER_H
@@ -8,67 +9,84 @@
 
 class CharStream {
 public:
-  CharStream(std::string data);
+  CharStream(std::string_view data);
   char current() const;
-  void advance(u_int16_t offset=1);
-  char peek(u_int16_t offset=1) const;
+  void advance(size_t offset=1);
+  char peek(size_t offset=1) const;
   void reset();
   bool end() const;
-  TokenPos position() const;
+  size_t offset() const { return index; }
 
 private:
-  u_int16_t index=0;
+  size_t index=0;
   ssize_t size;
-  std::unique_ptr<char[]> buffer;
-  TokenPos pos;
+  const char *buffer;
 };
 
+class WindLexer;
+
+// Tokens of a source. A stream built on a lexer pulls tokens on demand into
+// a ring buffer, so a Token* stays valid for RING_SIZE-1 tokens only and
+// getVec/join are unavailable.
 class TokenStream {
 public:
   TokenStream();
-  void push(Token *token);
+  TokenStream(WindLexer *source);
+  void push(const Token &token);
   Token *pop();
   void reset();
   Token *current() const;
-  void advance(int16_t index=1);
-  Token *peek(u_int16_t offset=1) const;
+  void advance(ssize_t index=1);
+  Token *peek(size_t offset=1) const;
   bool end() const;
   Token *last() const;
-  std::vector<Token*> getVec() const;
+  const std::vector<Token> &getVec() const;
   void join(TokenStream *stream);
-  void joinAfterindex(TokenStream *stream, u_int16_t index);
-  const u_int16_t getIndex() const { return index; }
+  void joinAfterindex(TokenStream *stream, size_t index);
+  size_t getIndex() const { return index; }
+
+  static const size_t RING_SIZE = 256;
 
 private:
-  u_int16_t index=0;
-  std::vector<Token*> tokens;
+  size_t index=0;
+  mutable std::vector<Token> tokens;
+  WindLexer *source=nullptr;
+  mutable size_t produced=0;
+  mutable bool exhausted=false;
+
+  bool available(size_t at) const;
+  Token *slot(size_t at) const;
 };
 
-typedef std::unique_ptr<std::pair<std::string, Token::Type>> SymbolMatch;
+typedef int SymbolMatch; // index in SymbolTable, -1 if none
 
 class WindLexer {
 public:
-  WindLexer(std::string data);
+  WindLexer(std::string_view data, bool streaming=false);
   TokenStream *tokenize();
+  bool next(Token &token);
   TokenStream *get();
-  std::string source() const;
+  std::string_view source() const;
   uint16_t srcId;
 
 private:
   CharStream stream;
   LexerReport *reporter;
   TokenStream *tokens;
-  std::string source_back;
+  std::string_view source_back;
   
-  Token *Discriminate();
-  Token *LexHexadecimal();
-  Token *LexIdentifier();
-  Token *LexSymbol(const SymbolMatch& type);
-  Token *LexString();
-  Token *LexChar();
+  bool Discriminate(Token &token);
+  Token LexHexadecimal();
+  Token LexIdentifier();
+  Token LexSymbol(SymbolMatch symbol);
+  Token LexString();
+  Token LexChar();
+  std::string_view rest() const;
+  Token MakeToken(Token::Type type, size_t start, std::string_view value);
   SymbolMatch MatchSymbol();
 };
 
 WindLexer *TokenizeFile(const char *filename);
+WindLexer *StreamFile(const char *filename);
 
 #endif
\ No newline at end of file
@@ -2,6 +2,8 @@
 #include <wind/bridge/ast.h>
 #include <wind/reporter/parser.h>
 #include <map>
+#include <memory>
+#include <vector>
 #ifndef PARSER_H
 #define PARSER_H
 
@@ -11,17 +13,18 @@ public:
   ASTNode *DiscriminateTop();
   ASTNode *DiscriminateBody();
   Body *parse();
-  
+  // Threads parsing function bodies, 1 parses them inline
+  void setJobs(unsigned jobs) { this->jobs = jobs; }
+
 
 private:
   Token *expect(Token::Type type, std::string str_repr);
   Token *expect(std::string value, std::string str_repr);
   Token *expect(Token::Type type, std::string value, std::string str_repr);
 
-  bool isKeyword(Token *src, std::string value);
+  bool isKeyword(Token *src, Keyword keyword);
   bool until(Token::Type type);
-  std::string typeSignature(Token::Type until, Token::Type oruntil);
-  std::string typeSignature(Token::Type while_);
+  const TypeExpr *parseType();
   Function *parseFn();
   Return *parseRet();
   VariableDecl *parseVarDecl();
@@ -45,11 +48,28 @@ private:
   void pathWorkInclude(std::string relative, Token *token_ref);
   void pathWorkImport(std::string relative, Token *token_ref);
 
+  typedef std::map<std::string, ASTNode*> ConstTable;
+
+  // A function body skipped by the first pass, with the constants visible
+  // at its position
+  struct DeferredBody {
+    Body *body;
+    TokenStream *tokens;
+    std::shared_ptr<const ConstTable> consts;
+  };
+
+  void deferBody(Body *fn_body);
+  void parseBody(Body *fn_body);
+  void parseDeferredBodies();
+
 private:
   TokenStream *stream;
   std::string file_path;
   Body *ast;
   int flag_holder=0;
+  unsigned jobs=1;
+  std::vector<DeferredBody> deferred;
+  std::shared_ptr<const ConstTable> consts_snapshot; // reset when the constants change
 };
 
 #endif
\ No newline at end of file
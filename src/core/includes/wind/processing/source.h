@@ -0,0 +1,51 @@
+#include <string>
+#include <string_view>
+#include <vector>
+#include <wind/processing/token.h>
+
+#ifndef SOURCE_H
+#define SOURCE_H
+
+// Offsets of the line starts of a source, so diagnostics find a line or the
+// position of an offset with a binary search instead of rescanning the text.
+class LineIndex {
+public:
+  void build(std::string_view source);
+  bool built() const { return !this->starts.empty(); }
+  TokenPos position(size_t offset) const;
+  std::string_view line(uint32_t line) const;
+
+private:
+  std::string_view source;
+  std::vector<uint32_t> starts;
+};
+
+// Read-only view of a source file shared by the lexer, the reporters and the
+// ISC. Files are mapped, so the text is never copied; in-memory sources
+// (literals, files without a final newline) keep their own copy.
+// The text always ends with '\n' unless it is empty.
+class SourceBuffer {
+public:
+  SourceBuffer(std::string data);
+  ~SourceBuffer();
+  std::string_view view() const { return std::string_view(this->data, this->size); }
+  // Built by the lexer entry points, before any token is handed out
+  void indexLines();
+  const LineIndex &lines() const { return this->line_index; }
+
+  static SourceBuffer *Map(const char *path);
+
+private:
+  SourceBuffer(const char *data, size_t size) : data(data), size(size), mapped(true) {}
+
+  const char *data;
+  size_t size;
+  bool mapped;
+  std::string owned;
+  LineIndex line_index;
+};
+
+// Line and column (both from 1) of an offset in a source
+TokenPos SourcePosition(std::string_view source, size_t offset);
+
+#endif
@@ -1,18 +1,60 @@
 #include <string>
+#include <string_view>
+#include <vector>
 #include <map>
 #include <stdint.h>
 
 #ifndef TOKEN_H
 #define TOKEN_H
 
-typedef std::pair<u_int16_t, u_int16_t> TokenPos;
+typedef std::pair<uint32_t, uint32_t> TokenPos; // line, column
 typedef std::pair<TokenPos, TokenPos> TokenRange;
 
 typedef uint16_t TokenSrcId;
+typedef uint32_t TokenSymbol; // id in the ISC interner (see WindInterner)
 
-class Token {
-public:
-  enum Type {
+// Identifiers the parser looks for, interned first so they have fixed ids
+enum Keyword : TokenSymbol {
+  KW_FUNC,
+  KW_GLOBAL,
+  KW_RETURN,
+  KW_VAR,
+  KW_ASM,
+  KW_BRANCH,
+  KW_LOOP,
+  KW_BREAK,
+  KW_CONTINUE,
+  KW_TRY,
+  KW_ELSE,
+  KW_FINALLY,
+  KW_PTR,
+  KW_TRUE,
+  KW_FALSE,
+  KW_NULL,
+  KW_GUARD,
+  KW_SIZEOF,
+  KW_PURE,
+  KW_EXTERN,
+  KW_PUB,
+  KW_INCLUDE,
+  KW_IMPORT,
+  KW_LINKFLAG,
+  KW_TYPE,
+  KW_CONST,
+  KW_COUNT
+};
+
+std::vector<std::string> const KeywordTable = {
+  "func", "global", "return", "var", "asm", "branch", "loop", "break",
+  "continue", "try", "else", "finally", "ptr", "true", "false", "Null",
+  "guard", "sizeof", "pure", "extern", "pub", "include", "import",
+  "linkflag", "type", "const"
+};
+
+// Tokens are plain 16-byte records: the text stays in the source buffer and
+// the value (identifier, number, string content or symbol) is interned.
+struct Token {
+  enum Type : uint8_t {
     IDENTIFIER,
     INTEGER,
     PLUS,
@@ -51,22 +93,50 @@ public:
     NOTEQ,
     NOT,
     ARROW,
-    CAST_SYMBOL
+    CAST_SYMBOL,
+    // Keywords, see KeywordKinds
+    FUNC,
+    GLOBAL,
+    RETURN,
+    VAR,
+    ASM,
+    BRANCH,
+    LOOP,
+    BREAK,
+    CONTINUE,
+    TRY,
+    ELSE,
+    FINALLY,
+    TRUE_LIT,
+    FALSE_LIT,
+    NULL_LIT,
+    GUARD,
+    SIZEOF
   };
   
-  std::string value;
   Token::Type type;
-  std::string name;
-  TokenRange range;
   TokenSrcId srcId;
+  uint32_t offset; // in the source
+  uint32_t length;
+  TokenSymbol symbol;
+
+  bool isKeyword() const { return this->type >= Token::Type::FUNC; }
+  const std::string &value() const;
+  std::string name() const;
+  TokenRange range() const;
+};
 
-  Token(
-    std::string value,
-    Token::Type type,
-    std::string name,
-    TokenRange range,
-    TokenSrcId srcId
-  ) : value(value), type(type), name(name), range(range), srcId(srcId) {}
+// Token kind of each Keyword, contextual ones (types, macros) stay identifiers
+Token::Type const KeywordKinds[KW_COUNT] = {
+  Token::Type::FUNC, Token::Type::GLOBAL, Token::Type::RETURN, Token::Type::VAR,
+  Token::Type::ASM, Token::Type::BRANCH, Token::Type::LOOP, Token::Type::BREAK,
+  Token::Type::CONTINUE, Token::Type::TRY, Token::Type::ELSE, Token::Type::FINALLY,
+  Token::Type::IDENTIFIER, // ptr
+  Token::Type::TRUE_LIT, Token::Type::FALSE_LIT, Token::Type::NULL_LIT,
+  Token::Type::GUARD, Token::Type::SIZEOF,
+  Token::Type::IDENTIFIER, Token::Type::IDENTIFIER, Token::Type::IDENTIFIER, // pure extern pub
+  Token::Type::IDENTIFIER, Token::Type::IDENTIFIER, Token::Type::IDENTIFIER, // include import linkflag
+  Token::Type::IDENTIFIER, Token::Type::IDENTIFIER // type const
 };
 
 std::vector<std::pair<std::string, Token::Type>> const SymbolTable = {
@@ -1,4 +1,5 @@
 #include <string>
+#include <stddef.h>
 #ifndef UTILS_H
 #define UTILS_H
 
@@ -7,14 +8,21 @@ namespace LexUtils {
   bool hexadecimal(char c);
   bool digit(char c);
   bool alphanum(char c);
+
+  // Vectorized scans over n bytes at most (see scan.cpp)
+  size_t whitespaceRun(const char *s, size_t n);
+  size_t alphanumRun(const char *s, size_t n);
+  size_t findChar(const char *s, size_t n, char c); // n if missing
 }
 
 std::string generateRandomFilePath(const std::string& directory, const std::string& extension);
 
-long long fmtinttostr(std::string &str);
+long long fmtinttostr(const std::string &str);
 
 std::string getRealPath(const std::string& path);
 
 std::string getExeDir();
 
+std::string resolveImportPath(const std::string& relative, const std::string& from);
+
 #endif
\ No newline at end of file
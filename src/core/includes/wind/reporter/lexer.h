@@ -1,9 +1,17 @@
 #include <string>
 #include <vector>
+#include <exception>
 #include <wind/processing/lexer.h>
 #ifndef LEXER_REP_H
 #define LEXER_REP_H
 
+// Thrown once lexer errors are printed. The driver exits with status 1 from
+// the main thread, as exiting from a compile thread would race the others.
+class LexerFailure : public std::exception {
+public:
+  const char *what() const noexcept override { return "lexer errors"; }
+};
+
 class LexerReport {
 public:
   enum Type {
@@ -18,6 +26,7 @@ public:
     TokenPos position
   );
   void handleErrors();
+  bool failed() const { return is_exiting; }
 
 private:
   bool is_exiting = false;
@@ -1,6 +1,7 @@
 #include <string>
+#include <string_view>
 #include <wind/processing/lexer.h>
-#include <sstream>
+#include <wind/processing/source.h>
 #include <iostream>
 #ifndef PARSER_REP_H
 #define PARSER_REP_H
@@ -12,15 +13,16 @@ public:
     PARSER_WARNING
   };
 
-  ParserReport(std::string srcx) : src(srcx) {}
+  ParserReport(const SourceBuffer *source) : lines(source->lines()) {}
   void Report(
     ParserReport::Type type,
-    Token *expecting=nullptr,
+    Token::Type expecting_type,
+    std::string expecting,
     Token *found=nullptr
   );
 private:
-  std::istringstream src;
-  std::string line(uint16_t line);
+  const LineIndex &lines;
+  std::string line(uint32_t line);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,13 @@
+#include <string>
+#ifndef USER_SERVER_H
+#define USER_SERVER_H
+
+// Compile server: `windc --server [socket]` keeps the standard and package
+// interfaces parsed, clients with $WIND_SERVER set forward their command
+// line (and their stdio) to it instead of compiling themselves.
+
+std::string DefaultServerSocket();
+int RunServer(std::string socket_path);
+bool ForwardToServer(std::string socket_path, int argc, char **argv, int &status);
+
+#endif
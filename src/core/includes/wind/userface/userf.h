@@ -1,7 +1,12 @@
 #include <string>
 #include <stdint.h>
 #include <vector>
+#include <set>
+#include <map>
+#include <mutex>
 #include <wind/backend/interface/ld.h>
+#include <wind/cache/cache.h>
+#include <wind/backend/writer/format/object.h>
 
 #ifndef USER_INTERFACE_H
 #define USER_INTERFACE_H
@@ -11,27 +16,63 @@
 #define SHOW_RAW_IR (1 << 2)
 #define SHOW_IR     (1 << 3)
 #define SHOW_ASM    (1 << 4)
+#define USE_CACHE   (1 << 5)
+#define EXTERNAL_AS (1 << 6)
+#define JIT_RUN     (1 << 7)
+#define TIME_REPORT (1 << 8)
+#define MEM_REPORT  (1 << 9)
+#define USE_PREBUILT (1 << 10)
+
+#define SHOW_ANY (SHOW_AST | SHOW_RAW_IR | SHOW_IR | SHOW_ASM)
+// Flags that never change the emitted objects
+#define NO_EMISSION_FLAGS (USE_CACHE | JIT_RUN | TIME_REPORT | MEM_REPORT | USE_PREBUILT)
 
 typedef uint16_t EmissionFlags;
 
+// Everything a single input file (and the packages it imports) produces
+struct CompileUnit {
+  std::vector<std::string> objects;
+  std::vector<ObjectImage> images; // kept in memory for --run
+  std::vector<std::string> prebuilt; // package objects shipped next to their .wi, never removed
+  std::vector<std::string> ld_flags;
+  std::vector<std::string> imports; // package sources, compiled once the unit pass is done
+};
+
 class WindUserInterface {
 public:
   WindUserInterface(int argc, char **argv);
   ~WindUserInterface();
 
   void processFiles();
-  void emitObject(std::string path);
+  void emitObject(std::string path, CompileUnit &unit);
+  void emitImport(std::string path, CompileUnit &unit);
 
 private:
   void parseArgument(std::string arg, int &i);
+  std::string takeValue(const std::string &arg, int &i);
+  void compileUnits(std::vector<CompileUnit> &units);
+  void runUnits(const std::vector<std::string> &paths, std::vector<CompileUnit> &units, bool packages);
+  std::vector<std::string> claimImports(const std::vector<CompileUnit> &units);
+  bool claimSource(std::string path);
   void ldDefFlags(WindLdInterface *ld);
   void ldExecFlags(WindLdInterface *ld);
+  int runProgram(std::vector<CompileUnit> &units);
+  void reportTiming();
 
   std::vector<std::string> files;
   std::string output;
+  std::string trace_path;
   EmissionFlags flags;
+  unsigned jobs;
+  unsigned parse_jobs; // threads parsing the function bodies of a unit
+  WindObjectCache *cache;
   std::vector<std::string> objects;
+  std::vector<std::string> prebuilt;
+  std::set<std::string> claimed_sources; // every source compiled by this invocation
+  std::mutex claimed_mutex;
   std::vector<std::string> user_ld_flags;
+  std::vector<std::string> run_args;
+  int argc;
   char **argv;
 };
 
@@ -1,18 +1,107 @@
 #include <wind/backend/interface/gas.h>
 #include <wind/common/debug.h>
+#include <wind/processing/utils.h>
+#include <wind/common/timing.h>
 
-WindGasInterface::WindGasInterface(std::string path, std::string outpath) : file_path(path), outpath(outpath) {}
+#include <spawn.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <cerrno>
+#include <ctime>
+
+extern char **environ;
+
+WindGasInterface::WindGasInterface(std::string source, std::string outpath) : source(source), outpath(outpath), retcode(0) {}
 
 void WindGasInterface::addFlag(std::string flag) {
-  this->flags += " " + flag;
+  this->flags.push_back(flag);
 }
 
+/**
+ * @brief Writes the whole buffer to a pipe.
+ * @param fd The write end of the pipe.
+ * @param data The buffer to write.
+ * @return False if the reader went away early.
+ *
+ * SIGPIPE is blocked for the calling thread while writing, so an assembler
+ * dying mid-stream surfaces as EPIPE instead of killing the compiler.
+ */
+static bool writeAll(int fd, const std::string &data) {
+  sigset_t pipe_set, old_set;
+  sigemptyset(&pipe_set);
+  sigaddset(&pipe_set, SIGPIPE);
+  pthread_sigmask(SIG_BLOCK, &pipe_set, &old_set);
+
+  bool ok = true;
+  size_t done = 0;
+  while (done < data.size()) {
+    ssize_t n = write(fd, data.data() + done, data.size() - done);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      ok = false;
+      break;
+    }
+    done += n;
+  }
+
+  if (!ok) {
+    struct timespec zero = {0, 0};
+    sigtimedwait(&pipe_set, nullptr, &zero);
+  }
+  pthread_sigmask(SIG_SETMASK, &old_set, nullptr);
+  return ok;
+}
+
+/**
+ * @brief Assembles the source with `as`, feeding it through a pipe.
+ * @return The path to the produced object file.
+ */
 std::string WindGasInterface::assemble() {
+  WindTimer timer("as");
   if (this->outpath == "") {
-    this->outpath = this->file_path + ".o";
+    this->outpath = generateRandomFilePath("", ".o");
   }
-  std::string command = "as " + this->file_path + " -o " + outpath + this->flags;
-  this->retcode = std::system(command.c_str());
-  std::remove(this->file_path.c_str());
-  return outpath;
+
+  std::vector<char*> argv;
+  argv.push_back((char*)"as");
+  // Mark the stack non-executable, like the objects of the binary writer
+  argv.push_back((char*)"--noexecstack");
+  for (std::string &flag : this->flags) {
+    argv.push_back((char*)flag.c_str());
+  }
+  argv.push_back((char*)"-o");
+  argv.push_back((char*)this->outpath.c_str());
+  argv.push_back((char*)"--");
+  argv.push_back(nullptr);
+
+  // O_CLOEXEC keeps the pipe out of assemblers spawned by other workers
+  int fds[2];
+  if (pipe2(fds, O_CLOEXEC) != 0) {
+    this->retcode = -1;
+    return this->outpath;
+  }
+
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_adddup2(&actions, fds[0], STDIN_FILENO);
+
+  pid_t pid;
+  int err = posix_spawnp(&pid, "as", &actions, nullptr, argv.data(), environ);
+  posix_spawn_file_actions_destroy(&actions);
+  close(fds[0]);
+  if (err != 0) {
+    close(fds[1]);
+    this->retcode = -1;
+    return this->outpath;
+  }
+
+  writeAll(fds[1], this->source);
+  close(fds[1]);
+
+  int status;
+  while (waitpid(pid, &status, 0) < 0 && errno == EINTR);
+  this->retcode = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+  return this->outpath;
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include <wind/backend/interface/ld.h>
 #include <wind/common/debug.h>
 #include <wind/processing/utils.h>
+#include <wind/common/timing.h>
 
 WindLdInterface::WindLdInterface(std::string output): output(output) {}
 
@@ -13,6 +14,7 @@ void WindLdInterface::addFile(std::string input) {
 }
 
 std::string WindLdInterface::link() {
+  WindTimer timer("ld");
   if (this->output == "") {
     this->output = generateRandomFilePath("", ".out");
   }
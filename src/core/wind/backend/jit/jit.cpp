@@ -0,0 +1,278 @@
+/**
+ * @file jit.cpp
+ * @brief Implementation of the in-process loader used by `windc --run`.
+ */
+
+#include <wind/backend/jit/jit.h>
+#include <wind/backend/writer/format/elf.h>
+#include <wind/common/timing.h>
+
+#include <elf.h>
+#include <dlfcn.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cstring>
+#include <cstdio>
+#include <set>
+
+#define JIT_STUB_SIZE 16
+
+/**
+ * @brief Rounds a value up to the given power of two.
+ */
+static uint64_t AlignUp(uint64_t value, uint64_t align) {
+  return align > 1 ? (value + align - 1) & ~(align - 1) : value;
+}
+
+/**
+ * @brief Destructor for WindJit, unmaps the code and closes the libraries.
+ */
+WindJit::~WindJit() {
+  if (this->memory) {
+    munmap(this->memory, this->memory_size);
+  }
+  for (void *handle : this->handles) {
+    dlclose(handle);
+  }
+}
+
+/**
+ * @brief Adds an image produced by the binary emitter.
+ */
+void WindJit::addImage(ObjectImage &image) {
+  this->images.push_back(image);
+}
+
+/**
+ * @brief Adds an ELF relocatable object (text fallback, runtime, cache).
+ * @param path The object path.
+ * @return False if the object can't be read.
+ */
+bool WindJit::addObject(std::string path) {
+  ObjectImage image;
+  WindElfReader reader(image);
+  if (!reader.Read(path)) {
+    return this->fail("Cannot load object " + path);
+  }
+  this->images.push_back(image);
+  return true;
+}
+
+/**
+ * @brief Records a link flag; `-l` libraries are opened at link time.
+ * @param flag The flag as passed to ld.
+ */
+void WindJit::addLdFlag(std::string flag) {
+  if (flag.rfind("-L", 0) == 0 && flag.size() > 2) {
+    this->lib_dirs.push_back(flag.substr(2));
+  } else if (flag.rfind("-l", 0) == 0 && flag.size() > 2) {
+    this->libs.push_back(flag.substr(2));
+  }
+}
+
+/**
+ * @brief Looks an extern up in windc itself and in the opened libraries.
+ */
+void *WindJit::resolveExtern(const std::string &name) {
+  void *addr = dlsym(RTLD_DEFAULT, name.c_str());
+  for (size_t i = 0; !addr && i < this->handles.size(); i++) {
+    addr = dlsym(this->handles[i], name.c_str());
+  }
+  return addr;
+}
+
+/**
+ * @brief Gets the jump stub of an extern too far for a rel32 call.
+ * @param name The extern name.
+ * @param target The resolved address.
+ * @return The stub address, inside the code mapping.
+ *
+ * A stub is `jmp qword ptr [rip]` followed by the absolute target.
+ */
+uint8_t *WindJit::stubFor(const std::string &name, void *target) {
+  auto it = this->stubs.find(name);
+  if (it != this->stubs.end()) {
+    return it->second;
+  }
+  uint8_t *stub = this->memory + this->stub_offset + this->stub_count++ * JIT_STUB_SIZE;
+  const uint8_t jmp[] = {0xff, 0x25, 0x00, 0x00, 0x00, 0x00};
+  memcpy(stub, jmp, sizeof(jmp));
+  uint64_t addr = (uint64_t)target;
+  memcpy(stub + sizeof(jmp), &addr, sizeof(addr));
+  this->stubs[name] = stub;
+  return stub;
+}
+
+/**
+ * @brief Maps every image, resolves symbols and applies relocations.
+ * @return False on error, see getError().
+ *
+ * Everything lives in a single mapping below 2GB (MAP_32BIT), so absolute
+ * 32-bit and PC-relative references between images always fit. Code comes
+ * first and is made read+exec once relocated, data follows read+write.
+ */
+bool WindJit::link() {
+  WindTimer timer("jit");
+  std::string missing = "";
+  for (std::string &lib : this->libs) {
+    void *handle = nullptr;
+    for (size_t i = 0; !handle && i <= this->lib_dirs.size(); i++) {
+      std::string path = "lib" + lib + ".so";
+      if (i < this->lib_dirs.size()) {
+        path = this->lib_dirs[i] + "/" + path;
+      }
+      handle = dlopen(path.c_str(), RTLD_NOW | RTLD_GLOBAL);
+    }
+    if (handle) {
+      this->handles.push_back(handle);
+    } else {
+      // Linker scripts (libm.so) can't be opened; what they provide is often
+      // loaded already, so only complain if a symbol stays undefined
+      missing += " (cannot load -l" + lib + ")";
+    }
+  }
+
+  std::vector<std::vector<uint64_t>> bases(this->images.size());
+  std::set<std::string> defined, undefined;
+  for (size_t i = 0; i < this->images.size(); i++) {
+    bases[i].assign(this->images[i].sections.size(), 0);
+    for (ObjectSymbol &sym : this->images[i].symbols) {
+      if (sym.global && sym.section >= 0) {
+        if (!defined.insert(sym.name).second) {
+          return this->fail("Duplicate symbol " + sym.name);
+        }
+      }
+    }
+  }
+  for (size_t i = 0; i < this->images.size(); i++) {
+    for (ObjectSymbol &sym : this->images[i].symbols) {
+      if (sym.section < 0 && !sym.name.empty() && !defined.count(sym.name)) {
+        undefined.insert(sym.name);
+      }
+    }
+  }
+
+  uint64_t offset = 0;
+  for (int exec = 1; exec >= 0; exec--) {
+    for (size_t i = 0; i < this->images.size(); i++) {
+      for (size_t s = 0; s < this->images[i].sections.size(); s++) {
+        ObjectSection &section = this->images[i].sections[s];
+        if (section.exec != (bool)exec) continue;
+        offset = AlignUp(offset, section.align);
+        bases[i][s] = offset;
+        offset += section.data.size();
+      }
+    }
+    if (exec) {
+      this->stub_offset = AlignUp(offset, JIT_STUB_SIZE);
+      offset = this->stub_offset + undefined.size() * JIT_STUB_SIZE;
+      this->code_size = AlignUp(offset, getpagesize());
+      offset = this->code_size;
+    }
+  }
+  this->memory_size = AlignUp(offset + 1, getpagesize());
+  void *mem = mmap(
+    nullptr, this->memory_size, PROT_READ | PROT_WRITE,
+    MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT, -1, 0
+  );
+  if (mem == MAP_FAILED) {
+    return this->fail("Cannot map memory for the program");
+  }
+  this->memory = (uint8_t*)mem;
+
+  for (size_t i = 0; i < this->images.size(); i++) {
+    ObjectImage &image = this->images[i];
+    for (size_t s = 0; s < image.sections.size(); s++) {
+      memcpy(this->memory + bases[i][s], image.sections[s].data.data(), image.sections[s].data.size());
+    }
+    for (ObjectSymbol &sym : image.symbols) {
+      if (sym.global && sym.section >= 0) {
+        this->globals[sym.name] = this->memory + bases[i][sym.section] + sym.value;
+      }
+    }
+  }
+
+  for (size_t i = 0; i < this->images.size(); i++) {
+    ObjectImage &image = this->images[i];
+    for (ObjectReloc &reloc : image.relocs) {
+      if (reloc.type == R_X86_64_NONE) continue;
+      uint64_t width = reloc.type == R_X86_64_64 ? 8 : 4;
+      if (reloc.section >= image.sections.size() ||
+          reloc.offset + width > image.sections[reloc.section].data.size() ||
+          reloc.symbol >= image.symbols.size()) {
+        return this->fail("Malformed relocation");
+      }
+      ObjectSymbol &sym = image.symbols[reloc.symbol];
+      uint8_t *place = this->memory + bases[i][reloc.section] + reloc.offset;
+      uint8_t *target = nullptr;
+      bool external = false;
+      if (sym.section >= 0) {
+        target = this->memory + bases[i][sym.section] + sym.value;
+      } else if (this->globals.count(sym.name)) {
+        target = this->globals[sym.name];
+      } else {
+        target = (uint8_t*)this->resolveExtern(sym.name);
+        external = true;
+        if (!target) {
+          return this->fail("Undefined symbol " + sym.name + missing);
+        }
+      }
+
+      int64_t value = (int64_t)(uint64_t)target + reloc.addend;
+      switch (reloc.type) {
+        case R_X86_64_64:
+          memcpy(place, &value, 8);
+          continue;
+        case R_X86_64_PC32:
+        case R_X86_64_PLT32:
+          value -= (int64_t)(uint64_t)place;
+          if (external && (value < INT32_MIN || value > INT32_MAX)) {
+            // Externs are functions: reach them through a stub
+            target = this->stubFor(sym.name, target);
+            value = (int64_t)(uint64_t)target + reloc.addend - (int64_t)(uint64_t)place;
+          }
+          break;
+        case R_X86_64_32:
+          if (value < 0 || value > UINT32_MAX) {
+            return this->fail("Relocation out of range for " + sym.name);
+          }
+          break;
+        case R_X86_64_32S:
+          break;
+        default:
+          return this->fail("Unsupported relocation type " + std::to_string(reloc.type));
+      }
+      if (reloc.type != R_X86_64_32 && (value < INT32_MIN || value > INT32_MAX)) {
+        return this->fail("Relocation out of range for " + sym.name);
+      }
+      uint32_t field = (uint32_t)value;
+      memcpy(place, &field, 4);
+    }
+  }
+
+  if (mprotect(this->memory, this->code_size, PROT_READ | PROT_EXEC) != 0) {
+    return this->fail("Cannot make the program executable");
+  }
+  return true;
+}
+
+/**
+ * @brief Calls the linked `main`.
+ * @param argc Argument count passed to main.
+ * @param argv Argument vector passed to main.
+ * @return The value main returned, or -1 with getError() set.
+ *
+ * The runtime's _start is skipped; stdio is flushed once main returns since
+ * the program shares the streams of windc.
+ */
+int WindJit::run(int argc, char **argv) {
+  auto entry = this->globals.find("main");
+  if (entry == this->globals.end()) {
+    this->fail("No main function to run");
+    return -1;
+  }
+  int (*main_fn)(int, char**) = (int (*)(int, char**))entry->second;
+  int ret = main_fn(argc, argv);
+  fflush(nullptr);
+  return ret;
+}
@@ -0,0 +1,913 @@
+/**
+ * @file encode.cpp
+ * @brief Machine code encoding and linking for the Bx86_64 writer.
+ */
+
+#include <wind/backend/writer/writer.h>
+#include <elf.h>
+#include <cctype>
+#include <cstring>
+#include <unordered_map>
+
+namespace {
+
+enum class OpKind {
+    ALU,    // add/or/and/sub/xor/cmp, ext is the /digit
+    MOV,
+    TEST,
+    LEA,
+    IMUL,
+    SHIFT,  // ext is the /digit
+    MOVZX,
+    MOVSX,
+    UNARY,  // div/idiv, ext is the /digit
+    PUSH,
+    POP,
+    BRANCH, // call/jmp, ext is the /digit of the indirect form
+    JCC,    // ext is the condition code
+    SETCC   // ext is the condition code
+};
+
+struct OpDesc {
+    OpKind kind;
+    uint8_t ext;
+};
+
+const std::unordered_map<std::string, OpDesc> OP_TABLE = {
+    {"add", {OpKind::ALU, 0}}, {"or", {OpKind::ALU, 1}}, {"adc", {OpKind::ALU, 2}},
+    {"sbb", {OpKind::ALU, 3}}, {"and", {OpKind::ALU, 4}}, {"sub", {OpKind::ALU, 5}},
+    {"xor", {OpKind::ALU, 6}}, {"cmp", {OpKind::ALU, 7}},
+    {"mov", {OpKind::MOV, 0}},
+    {"test", {OpKind::TEST, 0}},
+    {"lea", {OpKind::LEA, 0}},
+    {"imul", {OpKind::IMUL, 0}},
+    {"shl", {OpKind::SHIFT, 4}}, {"sal", {OpKind::SHIFT, 4}},
+    {"shr", {OpKind::SHIFT, 5}}, {"sar", {OpKind::SHIFT, 7}},
+    {"movzx", {OpKind::MOVZX, 0}},
+    {"movsx", {OpKind::MOVSX, 0}},
+    {"div", {OpKind::UNARY, 6}}, {"idiv", {OpKind::UNARY, 7}},
+    {"push", {OpKind::PUSH, 6}},
+    {"pop", {OpKind::POP, 0}},
+    {"call", {OpKind::BRANCH, 2}}, {"jmp", {OpKind::BRANCH, 4}},
+    {"jo", {OpKind::JCC, 0}}, {"jno", {OpKind::JCC, 1}},
+    {"jb", {OpKind::JCC, 2}}, {"jc", {OpKind::JCC, 2}},
+    {"jnb", {OpKind::JCC, 3}}, {"jae", {OpKind::JCC, 3}}, {"jnc", {OpKind::JCC, 3}},
+    {"je", {OpKind::JCC, 4}}, {"jz", {OpKind::JCC, 4}},
+    {"jne", {OpKind::JCC, 5}}, {"jnz", {OpKind::JCC, 5}},
+    {"jbe", {OpKind::JCC, 6}}, {"ja", {OpKind::JCC, 7}},
+    {"js", {OpKind::JCC, 8}}, {"jns", {OpKind::JCC, 9}},
+    {"jp", {OpKind::JCC, 10}}, {"jnp", {OpKind::JCC, 11}},
+    {"jl", {OpKind::JCC, 12}}, {"jge", {OpKind::JCC, 13}},
+    {"jle", {OpKind::JCC, 14}}, {"jg", {OpKind::JCC, 15}},
+    {"seto", {OpKind::SETCC, 0}}, {"setno", {OpKind::SETCC, 1}},
+    {"setb", {OpKind::SETCC, 2}}, {"setae", {OpKind::SETCC, 3}},
+    {"sete", {OpKind::SETCC, 4}}, {"setne", {OpKind::SETCC, 5}},
+    {"setbe", {OpKind::SETCC, 6}}, {"seta", {OpKind::SETCC, 7}},
+    {"sets", {OpKind::SETCC, 8}}, {"setns", {OpKind::SETCC, 9}},
+    {"setl", {OpKind::SETCC, 12}}, {"setge", {OpKind::SETCC, 13}},
+    {"setle", {OpKind::SETCC, 14}}, {"setg", {OpKind::SETCC, 15}}
+};
+
+const std::unordered_map<std::string, std::vector<uint8_t>> PLAIN_TABLE = {
+    {"leave", {0xC9}},
+    {"ret", {0xC3}},
+    {"rdtsc", {0x0F, 0x31}},
+    {"rdtscp", {0x0F, 0x01, 0xF9}},
+    {"cdq", {0x99}},
+    {"cqo", {0x48, 0x99}}
+};
+
+const OpDesc *FindOp(const std::string &instr) {
+    auto it = OP_TABLE.find(instr);
+    return it == OP_TABLE.end() ? nullptr : &it->second;
+}
+
+bool FitsInt8(int64_t v) { return v >= -128 && v <= 127; }
+bool FitsInt32(int64_t v) { return v >= INT32_MIN && v <= INT32_MAX; }
+
+} // namespace
+
+/**
+ * @brief Sets the operand size prefix or REX.W for a non byte operation.
+ * @return False on sizes x86 can't encode.
+ */
+bool Bx86_64::OperandSize(Encoding &enc, uint16_t size) {
+    switch (size) {
+        case 1:
+        case 4:
+            return true;
+        case 2:
+            enc.prefix[enc.n_prefix++] = 0x66;
+            return true;
+        case 8:
+            enc.rex |= 0x08;
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Places a register in the ModRM reg field.
+ */
+bool Bx86_64::RegField(Encoding &enc, Reg &reg) {
+    if (reg.type != Reg::GPR) return false;
+    enc.has_modrm = true;
+    enc.modrm |= (reg.id & 7) << 3;
+    if (reg.id & 8) enc.rex |= 0x04;
+    if (reg.size == 1 && reg.id >= 4 && reg.id <= 7) enc.force_rex = true; // spl..dil
+    return true;
+}
+
+/**
+ * @brief Places a register in the ModRM r/m field.
+ */
+bool Bx86_64::RmReg(Encoding &enc, Reg &reg) {
+    if (reg.type != Reg::GPR) return false;
+    enc.has_modrm = true;
+    enc.modrm |= 0xC0 | (reg.id & 7);
+    if (reg.id & 8) enc.rex |= 0x01;
+    if (reg.size == 1 && reg.id >= 4 && reg.id <= 7) enc.force_rex = true;
+    return true;
+}
+
+/**
+ * @brief Encodes a memory operand in the ModRM r/m field.
+ * @return False on addressing forms that can't be encoded.
+ *
+ * Label operands are rip relative unless they are indexed, in which case
+ * they use an absolute 32-bit displacement, as `as` does.
+ */
+bool Bx86_64::RmMem(Encoding &enc, Mem &mem) {
+    enc.has_modrm = true;
+    if (mem.base_type == Mem::BASE && mem.base.type == Reg::SEG) {
+        static const uint8_t SEG_PREFIX[6] = {0x26, 0x2E, 0x36, 0x3E, 0x64, 0x65};
+        if (mem.base.id > 5 || !FitsInt32(mem.offset)) return false;
+        enc.prefix[enc.n_prefix++] = SEG_PREFIX[mem.base.id];
+        enc.modrm |= 0x04;
+        enc.has_sib = true;
+        enc.sib = 0x25;
+        enc.disp_size = 4;
+        enc.disp = mem.offset;
+        return true;
+    }
+
+    bool indexed = mem.offset_type != Mem::IMM;
+    uint8_t scale = 0;
+    if (indexed) {
+        if (mem.index.type != Reg::GPR || mem.index.id == 4) return false;
+        uint16_t factor = mem.offset_type == Mem::REG_IMM ? mem.size : 1;
+        switch (factor) {
+            case 1: scale = 0; break;
+            case 2: scale = 1; break;
+            case 4: scale = 2; break;
+            case 8: scale = 3; break;
+            default: return false;
+        }
+        if (mem.index.id & 8) enc.rex |= 0x02;
+    }
+    // [label + index] drops the offset, as in ResolveMem
+    int64_t offset = mem.offset_type == Mem::REG ? 0 : mem.offset;
+    if (!FitsInt32(offset)) return false;
+
+    if (mem.base_type == Mem::LABEL) {
+        if (mem.label.empty()) return false;
+        enc.label = &mem.label;
+        enc.label_offset = offset;
+        enc.disp_size = 4;
+        if (indexed) {
+            enc.modrm |= 0x04;
+            enc.has_sib = true;
+            enc.sib = (scale << 6) | ((mem.index.id & 7) << 3) | 0x05;
+            enc.label_kind = Fixup::ABS32S;
+        } else {
+            enc.modrm |= 0x05;
+            enc.label_kind = Fixup::REL32;
+        }
+        return true;
+    }
+
+    if (mem.base.type != Reg::GPR) return false;
+    if (mem.base.size == 4) enc.prefix[enc.n_prefix++] = 0x67;
+    uint8_t base = mem.base.id & 7;
+    if (mem.base.id & 8) enc.rex |= 0x01;
+    if (indexed) {
+        enc.modrm |= 0x04;
+        enc.has_sib = true;
+        enc.sib = (scale << 6) | ((mem.index.id & 7) << 3) | base;
+    } else if (base == 4) {
+        enc.modrm |= 0x04;
+        enc.has_sib = true;
+        enc.sib = 0x24;
+    } else {
+        enc.modrm |= base;
+    }
+    if (offset == 0 && base != 5) {
+        enc.disp_size = 0;
+    } else if (FitsInt8(offset)) {
+        enc.modrm |= 0x40;
+        enc.disp_size = 1;
+    } else {
+        enc.modrm |= 0x80;
+        enc.disp_size = 4;
+    }
+    enc.disp = offset;
+    return true;
+}
+
+/**
+ * @brief Sets the immediate of an instruction.
+ * @param size The immediate width in bytes.
+ * @return False if the value doesn't fit.
+ */
+bool Bx86_64::Imm(Encoding &enc, int64_t imm, uint16_t size) {
+    switch (size) {
+        case 1:
+            if (imm < -128 || imm > 255) return false;
+            break;
+        case 2:
+            if (imm < -32768 || imm > 65535) return false;
+            break;
+        case 4:
+            if (imm < INT32_MIN || imm > (int64_t)UINT32_MAX) return false;
+            break;
+    }
+    enc.imm_size = size;
+    enc.imm = imm;
+    return true;
+}
+
+/**
+ * @brief Appends an encoded instruction to the current label.
+ */
+void Bx86_64::Emit(Encoding &enc) {
+    std::vector<uint8_t> &code = this->Current().code;
+    for (uint8_t i = 0; i < enc.n_prefix; i++) code.push_back(enc.prefix[i]);
+    if (enc.rex || enc.force_rex) code.push_back(0x40 | enc.rex);
+    for (uint8_t i = 0; i < enc.n_opcode; i++) code.push_back(enc.opcode[i]);
+    if (enc.has_modrm) code.push_back(enc.modrm);
+    if (enc.has_sib) code.push_back(enc.sib);
+    uint32_t disp_at = code.size();
+    for (uint8_t i = 0; i < enc.disp_size; i++) code.push_back((uint32_t)enc.disp >> (8 * i));
+    for (uint8_t i = 0; i < enc.imm_size; i++) code.push_back((uint64_t)enc.imm >> (8 * i));
+    if (enc.label) {
+        int64_t addend = enc.label_offset;
+        if (enc.label_kind != Fixup::ABS32S) {
+            // Displacements are relative to the end of the instruction
+            addend -= code.size() - disp_at;
+        }
+        this->Current().fixups.push_back({disp_at, *enc.label, addend, enc.label_kind});
+    }
+}
+
+/**
+ * @brief Encodes `instr r/m, imm` once the r/m operand is set.
+ */
+bool Bx86_64::EncodeRmImm(const std::string &instr, Encoding &enc, uint16_t size, int64_t imm) {
+    const OpDesc *op = FindOp(instr);
+    if (!op || !this->OperandSize(enc, size)) return false;
+    uint16_t imm_size = size == 8 ? 4 : size;
+    switch (op->kind) {
+        case OpKind::ALU:
+            this->Ext(enc, op->ext);
+            if (size == 1) {
+                this->Opcode(enc, 0x80);
+            } else if (FitsInt8(imm)) {
+                this->Opcode(enc, 0x83);
+                imm_size = 1;
+            } else {
+                this->Opcode(enc, 0x81);
+            }
+            break;
+        case OpKind::MOV:
+            this->Opcode(enc, size == 1 ? 0xC6 : 0xC7);
+            this->Ext(enc, 0);
+            break;
+        case OpKind::TEST:
+            this->Opcode(enc, size == 1 ? 0xF6 : 0xF7);
+            this->Ext(enc, 0);
+            break;
+        case OpKind::SHIFT:
+            this->Ext(enc, op->ext);
+            if (imm == 1) {
+                this->Opcode(enc, size == 1 ? 0xD0 : 0xD1);
+                return true;
+            }
+            this->Opcode(enc, size == 1 ? 0xC0 : 0xC1);
+            imm_size = 1;
+            break;
+        default:
+            return false;
+    }
+    if (size == 8 && imm_size == 4 && !FitsInt32(imm)) return false;
+    return this->Imm(enc, imm, imm_size);
+}
+
+/**
+ * @brief Encodes a two operand instruction once the r/m operand is set.
+ * @param reg The register operand.
+ * @param reg_is_dst Whether the register is the destination.
+ */
+bool Bx86_64::EncodeRmReg(const std::string &instr, Encoding &enc, uint16_t size, Reg &reg, bool reg_is_dst) {
+    const OpDesc *op = FindOp(instr);
+    if (!op) return false;
+    uint8_t byte_op = size == 1 ? 0 : 1;
+    switch (op->kind) {
+        case OpKind::ALU:
+            if (!this->OperandSize(enc, size)) return false;
+            this->Opcode(enc, op->ext * 8 + (reg_is_dst ? 2 : 0) + byte_op);
+            return this->RegField(enc, reg);
+        case OpKind::MOV:
+            if (!this->OperandSize(enc, size)) return false;
+            this->Opcode(enc, (reg_is_dst ? 0x8A : 0x88) + byte_op);
+            return this->RegField(enc, reg);
+        case OpKind::TEST:
+            if (!this->OperandSize(enc, size)) return false;
+            this->Opcode(enc, 0x84 + byte_op);
+            return this->RegField(enc, reg);
+        case OpKind::LEA:
+            if (!reg_is_dst || size == 1 || !this->OperandSize(enc, size)) return false;
+            this->Opcode(enc, 0x8D);
+            return this->RegField(enc, reg);
+        case OpKind::IMUL:
+            if (!reg_is_dst || size == 1 || !this->OperandSize(enc, size)) return false;
+            this->Opcode(enc, 0x0F);
+            this->Opcode(enc, 0xAF);
+            return this->RegField(enc, reg);
+        case OpKind::SHIFT:
+            // Only the count register form exists
+            if (reg_is_dst || reg.id != 1 || reg.size != 1 || !this->OperandSize(enc, size)) return false;
+            this->Opcode(enc, size == 1 ? 0xD2 : 0xD3);
+            this->Ext(enc, op->ext);
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Encodes an instruction without operands, or fails on raw text.
+ * @param content The instruction.
+ *
+ * Anything else reaching this overload is inline assembly, which the
+ * binary writer can't take; the caller falls back to the text writer.
+ */
+void Bx86_64::Write(std::string content) {
+    auto it = PLAIN_TABLE.find(content);
+    if (it == PLAIN_TABLE.end()) {
+        this->Fail();
+        return;
+    }
+    std::vector<uint8_t> &code = this->Current().code;
+    code.insert(code.end(), it->second.begin(), it->second.end());
+}
+
+void Bx86_64::Write(std::string instr, Reg dst, Reg src) {
+    const OpDesc *op = FindOp(instr);
+    Encoding enc;
+    bool ok = false;
+    if (op && (op->kind == OpKind::MOVZX || op->kind == OpKind::MOVSX)) {
+        bool sx = op->kind == OpKind::MOVSX;
+        ok = src.size < dst.size && this->OperandSize(enc, dst.size) && this->RegField(enc, dst) && this->RmReg(enc, src);
+        if (src.size == 1 || src.size == 2) {
+            this->Opcode(enc, 0x0F);
+            this->Opcode(enc, (sx ? 0xBE : 0xB6) + (src.size == 2));
+        } else if (src.size == 4 && dst.size == 8) {
+            if (sx) {
+                this->Opcode(enc, 0x63); // movsxd
+            } else {
+                // Writing the 32-bit register already zero extends
+                enc.rex &= ~0x08;
+                this->Opcode(enc, 0x8B);
+            }
+        } else {
+            ok = false;
+        }
+    } else if (op && op->kind == OpKind::IMUL) {
+        ok = dst.size == src.size && this->EncodeRmReg(instr, enc, dst.size, dst, true) && this->RmReg(enc, src);
+    } else if (op && op->kind == OpKind::SHIFT) {
+        ok = this->EncodeRmReg(instr, enc, dst.size, src, false) && this->RmReg(enc, dst);
+    } else {
+        uint16_t size = dst.size;
+        if (size == 8 && dst.id == src.id && (instr == "xor" || instr == "sub")) {
+            // Zeroing idiom, the 32-bit form clears the upper half as well
+            size = 4;
+        }
+        ok = dst.size == src.size && this->EncodeRmReg(instr, enc, size, src, false) && this->RmReg(enc, dst);
+    }
+    if (!ok) return this->Fail();
+    this->Emit(enc);
+}
+
+void Bx86_64::Write(std::string instr, Reg dst, Mem src) {
+    const OpDesc *op = FindOp(instr);
+    Encoding enc;
+    bool ok = false;
+    if (op && (op->kind == OpKind::MOVZX || op->kind == OpKind::MOVSX)) {
+        bool sx = op->kind == OpKind::MOVSX;
+        ok = src.size < dst.size && this->OperandSize(enc, dst.size) && this->RegField(enc, dst) && this->RmMem(enc, src);
+        if (src.size == 1 || src.size == 2) {
+            this->Opcode(enc, 0x0F);
+            this->Opcode(enc, (sx ? 0xBE : 0xB6) + (src.size == 2));
+        } else if (src.size == 4 && dst.size == 8) {
+            if (sx) {
+                this->Opcode(enc, 0x63);
+            } else {
+                enc.rex &= ~0x08;
+                this->Opcode(enc, 0x8B);
+            }
+        } else {
+            ok = false;
+        }
+    } else {
+        ok = this->EncodeRmReg(instr, enc, dst.size, dst, true) && this->RmMem(enc, src);
+    }
+    if (!ok) return this->Fail();
+    this->Emit(enc);
+}
+
+void Bx86_64::Write(std::string instr, Mem dst, Reg src) {
+    Encoding enc;
+    uint16_t size = src.size;
+    const OpDesc *op = FindOp(instr);
+    if (op && op->kind == OpKind::SHIFT) size = dst.size;
+    if (!this->EncodeRmReg(instr, enc, size, src, false) || !this->RmMem(enc, dst)) return this->Fail();
+    this->Emit(enc);
+}
+
+void Bx86_64::Write(std::string instr, Mem dst, int64_t imm) {
+    Encoding enc;
+    if (!this->RmMem(enc, dst) || !this->EncodeRmImm(instr, enc, dst.size, imm)) return this->Fail();
+    this->Emit(enc);
+}
+
+void Bx86_64::Write(std::string instr, Reg dst, int64_t imm) {
+    const OpDesc *op = FindOp(instr);
+    Encoding enc;
+    if (op && op->kind == OpKind::MOV) {
+        // mov r, imm: pick the shortest of imm32 sign/zero extended and imm64
+        if (dst.type != Reg::GPR) return this->Fail();
+        if (dst.id & 8) enc.rex |= 0x01;
+        if (dst.size == 1 && dst.id >= 4 && dst.id <= 7) enc.force_rex = true;
+        if (dst.size == 8 && FitsInt32(imm) && imm < 0) {
+            enc.rex |= 0x08;
+            this->Opcode(enc, 0xC7);
+            enc.has_modrm = true;
+            enc.modrm = 0xC0 | (dst.id & 7);
+            this->Imm(enc, imm, 4);
+        } else if (dst.size == 8 && (imm < 0 || imm > (int64_t)UINT32_MAX)) {
+            enc.rex |= 0x08;
+            this->Opcode(enc, 0xB8 + (dst.id & 7));
+            enc.imm_size = 8;
+            enc.imm = imm;
+        } else {
+            uint16_t size = dst.size == 8 ? 4 : dst.size;
+            if (!this->OperandSize(enc, size)) return this->Fail();
+            this->Opcode(enc, (size == 1 ? 0xB0 : 0xB8) + (dst.id & 7));
+            if (!this->Imm(enc, imm, size)) return this->Fail();
+        }
+        return this->Emit(enc);
+    }
+    if (op && op->kind == OpKind::IMUL) {
+        if (dst.size == 1 || !this->OperandSize(enc, dst.size)) return this->Fail();
+        if (!this->RegField(enc, dst) || !this->RmReg(enc, dst)) return this->Fail();
+        if (FitsInt8(imm)) {
+            this->Opcode(enc, 0x6B);
+            this->Imm(enc, imm, 1);
+        } else {
+            this->Opcode(enc, 0x69);
+            if (!FitsInt32(imm) || !this->Imm(enc, imm, dst.size == 2 ? 2 : 4)) return this->Fail();
+        }
+        return this->Emit(enc);
+    }
+    if (!this->RmReg(enc, dst) || !this->EncodeRmImm(instr, enc, dst.size, imm)) return this->Fail();
+    this->Emit(enc);
+}
+
+void Bx86_64::Write(std::string instr, int64_t imm, Reg src) {
+    // Only test is commutative
+    if (instr != "test") return this->Fail();
+    this->Write(instr, src, imm);
+}
+
+void Bx86_64::Write(std::string instr, int64_t imm, Mem src) {
+    if (instr != "test") return this->Fail();
+    this->Write(instr, src, imm);
+}
+
+void Bx86_64::Write(std::string instr, Reg dst) {
+    const OpDesc *op = FindOp(instr);
+    if (!op || dst.type != Reg::GPR) return this->Fail();
+    Encoding enc;
+    switch (op->kind) {
+        case OpKind::UNARY:
+            if (!this->OperandSize(enc, dst.size)) return this->Fail();
+            this->Opcode(enc, dst.size == 1 ? 0xF6 : 0xF7);
+            this->Ext(enc, op->ext);
+            this->RmReg(enc, dst);
+            break;
+        case OpKind::PUSH:
+        case OpKind::POP:
+            if (dst.size != 8 && dst.size != 2) return this->Fail();
+            if (dst.size == 2) this->OperandSize(enc, 2);
+            if (dst.id & 8) enc.rex |= 0x01;
+            this->Opcode(enc, (op->kind == OpKind::PUSH ? 0x50 : 0x58) + (dst.id & 7));
+            break;
+        case OpKind::BRANCH:
+            if (dst.size != 8) return this->Fail();
+            this->Opcode(enc, 0xFF);
+            this->Ext(enc, op->ext);
+            this->RmReg(enc, dst);
+            break;
+        case OpKind::SETCC:
+            if (dst.size != 1) return this->Fail();
+            this->Opcode(enc, 0x0F);
+            this->Opcode(enc, 0x90 + op->ext);
+            this->RmReg(enc, dst);
+            break;
+        default:
+            return this->Fail();
+    }
+    this->Emit(enc);
+}
+
+void Bx86_64::Write(std::string instr, Mem dst) {
+    const OpDesc *op = FindOp(instr);
+    if (!op) return this->Fail();
+    Encoding enc;
+    switch (op->kind) {
+        case OpKind::UNARY:
+            if (!this->OperandSize(enc, dst.size)) return this->Fail();
+            this->Opcode(enc, dst.size == 1 ? 0xF6 : 0xF7);
+            this->Ext(enc, op->ext);
+            break;
+        case OpKind::PUSH:
+        case OpKind::POP:
+            if (dst.size != 8 && dst.size != 2) return this->Fail();
+            if (dst.size == 2) this->OperandSize(enc, 2);
+            this->Opcode(enc, op->kind == OpKind::PUSH ? 0xFF : 0x8F);
+            this->Ext(enc, op->ext);
+            break;
+        case OpKind::BRANCH:
+            if (dst.size != 8) return this->Fail();
+            this->Opcode(enc, 0xFF);
+            this->Ext(enc, op->ext);
+            break;
+        case OpKind::SETCC:
+            if (dst.size != 1) return this->Fail();
+            this->Opcode(enc, 0x0F);
+            this->Opcode(enc, 0x90 + op->ext);
+            break;
+        default:
+            return this->Fail();
+    }
+    if (!this->RmMem(enc, dst)) return this->Fail();
+    this->Emit(enc);
+}
+
+void Bx86_64::Write(std::string instr, std::string label) {
+    const OpDesc *op = FindOp(instr);
+    if (!op || label.empty()) return this->Fail();
+    Encoding enc;
+    if (op->kind == OpKind::BRANCH) {
+        this->Opcode(enc, op->ext == 2 ? 0xE8 : 0xE9);
+    } else if (op->kind == OpKind::JCC) {
+        this->Opcode(enc, 0x0F);
+        this->Opcode(enc, 0x80 + op->ext);
+    } else {
+        return this->Fail();
+    }
+    enc.label = &label;
+    enc.label_kind = op->kind == OpKind::JCC || op->ext == 4 ? Fixup::JUMP32 : Fixup::BRANCH32;
+    enc.disp_size = 4;
+    this->Emit(enc);
+}
+
+void Bx86_64::Write(std::string instr, int64_t imm) {
+    const OpDesc *op = FindOp(instr);
+    if (!op || op->kind != OpKind::PUSH) return this->Fail();
+    Encoding enc;
+    if (FitsInt8(imm)) {
+        this->Opcode(enc, 0x6A);
+        this->Imm(enc, imm, 1);
+    } else if (FitsInt32(imm)) {
+        this->Opcode(enc, 0x68);
+        this->Imm(enc, imm, 4);
+    } else {
+        return this->Fail();
+    }
+    this->Emit(enc);
+}
+
+/**
+ * @brief Aligns the next byte of the current label.
+ *
+ * Padding is only known once the label is placed, so it is recorded and
+ * inserted by Link.
+ */
+void Bx86_64::Align(uint16_t size) {
+    if (size == 0 || (size & (size - 1))) {
+        return this->Fail();
+    }
+    Label &label = this->Current();
+    label.aligns.push_back({(uint32_t)label.code.size(), size});
+}
+
+/**
+ * @brief Emits a NUL terminated string, decoding escapes like `.string`.
+ * @param content The raw string.
+ */
+void Bx86_64::String(std::string content) {
+    std::vector<uint8_t> &code = this->Current().code;
+    for (size_t i = 0; i < content.size(); i++) {
+        char c = content[i];
+        if (c != '\\' || i + 1 == content.size()) {
+            code.push_back(c);
+            continue;
+        }
+        c = content[++i];
+        switch (c) {
+            case 'b': code.push_back('\b'); break;
+            case 'f': code.push_back('\f'); break;
+            case 'n': code.push_back('\n'); break;
+            case 'r': code.push_back('\r'); break;
+            case 't': code.push_back('\t'); break;
+            case 'x': case 'X': {
+                uint8_t value = 0;
+                while (i + 1 < content.size() && isxdigit((unsigned char)content[i + 1])) {
+                    char h = content[++i];
+                    value = value * 16 + (isdigit((unsigned char)h) ? h - '0' : (tolower(h) - 'a' + 10));
+                }
+                code.push_back(value);
+                break;
+            }
+            default:
+                if (c >= '0' && c <= '7') {
+                    uint8_t value = c - '0';
+                    for (int n = 0; n < 2 && i + 1 < content.size() && content[i + 1] >= '0' && content[i + 1] <= '7'; n++) {
+                        value = value * 8 + (content[++i] - '0');
+                    }
+                    code.push_back(value);
+                } else {
+                    code.push_back(c);
+                }
+        }
+    }
+    code.push_back(0);
+}
+
+void Bx86_64::Byte(long value) {
+    this->Current().code.push_back(value);
+}
+
+void Bx86_64::Word(long value) {
+    for (int i = 0; i < 2; i++) this->Current().code.push_back((uint64_t)value >> (8 * i));
+}
+
+void Bx86_64::Dword(long value) {
+    for (int i = 0; i < 4; i++) this->Current().code.push_back((uint64_t)value >> (8 * i));
+}
+
+void Bx86_64::Qword(long value) {
+    for (int i = 0; i < 8; i++) this->Current().code.push_back((uint64_t)value >> (8 * i));
+}
+
+void Bx86_64::Reserve(long size) {
+    this->Current().code.insert(this->Current().code.end(), size, 0);
+}
+
+
+namespace {
+
+// Point of a label where the final layout departs from the raw code
+struct LayoutEvent {
+    uint32_t start;    // offset of the event in the label code
+    uint16_t align;    // alignment, 0 for a jump
+    uint32_t fixup;    // index of the jump fixup in the label
+    uint8_t op_len;    // opcode length of the near jump
+    bool is_short;
+    uint64_t addr;     // section offset of the jump once placed
+};
+
+struct LabelLayout {
+    uint64_t addr;
+    std::vector<LayoutEvent> events;
+};
+
+const uint8_t SHORT_JUMP_LEN = 2;
+
+} // namespace
+
+/**
+ * @brief Lays out the sections and resolves label references.
+ * @param image Filled with the sections, symbols and relocations.
+ * @return False if something couldn't be encoded.
+ *
+ * Labels are placed in creation order, like Emit does for the text output.
+ * Jumps to labels of the same section start out short (rel8) and are grown
+ * to rel32 until every displacement fits, so the layout only ever grows and
+ * the iteration terminates. References inside a section are then patched
+ * directly; the rest become relocations against the target symbol, or its
+ * section symbol when the target is local.
+ */
+bool Bx86_64::Link(ObjectImage &image) {
+    if (this->unsupported) {
+        return false;
+    }
+    struct LabelRef {
+        uint16_t section;
+        uint32_t label;
+    };
+    struct PendingFixup {
+        uint16_t section;
+        uint64_t at;
+        const Fixup *fixup;
+    };
+    std::unordered_map<std::string, LabelRef> label_refs;
+    for (uint16_t s = 0; s < content.sections.size(); s++) {
+        for (uint32_t l = 0; l < content.sections[s].labels.size(); l++) {
+            label_refs[content.sections[s].labels[l].name] = {s, l};
+        }
+    }
+
+    // Collect alignments and relaxable jumps of every label, in code order
+    std::vector<std::vector<LabelLayout>> layouts(content.sections.size());
+    for (uint16_t s = 0; s < content.sections.size(); s++) {
+        for (Label &label : content.sections[s].labels) {
+            LabelLayout layout = {0, {}};
+            size_t a = 0;
+            for (uint32_t f = 0; f <= label.fixups.size(); f++) {
+                uint32_t limit = f < label.fixups.size() ? label.fixups[f].offset : UINT32_MAX;
+                while (a < label.aligns.size() && label.aligns[a].first <= limit) {
+                    layout.events.push_back({label.aligns[a].first, label.aligns[a].second, 0, 0, false, 0});
+                    a++;
+                }
+                if (f == label.fixups.size()) break;
+                const Fixup &fixup = label.fixups[f];
+                auto target = label_refs.find(fixup.target);
+                if (fixup.kind != Fixup::JUMP32 || target == label_refs.end() || target->second.section != s) {
+                    continue;
+                }
+                uint8_t op_len = label.code[fixup.offset - 1] == 0xE9 ? 1 : 2;
+                layout.events.push_back({fixup.offset - op_len, 0, f, op_len, true, 0});
+            }
+            layouts[s].push_back(layout);
+        }
+    }
+
+    for (uint16_t s = 0; s < content.sections.size(); s++) {
+        std::vector<Label> &labels = content.sections[s].labels;
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            uint64_t off = 0;
+            for (uint32_t l = 0; l < labels.size(); l++) {
+                LabelLayout &layout = layouts[s][l];
+                layout.addr = off;
+                uint32_t pos = 0;
+                for (LayoutEvent &event : layout.events) {
+                    off += event.start - pos;
+                    pos = event.start;
+                    if (event.align) {
+                        off = (off + event.align - 1) & ~(uint64_t)(event.align - 1);
+                        continue;
+                    }
+                    event.addr = off;
+                    off += event.is_short ? SHORT_JUMP_LEN : event.op_len + 4;
+                    pos += event.op_len + 4;
+                }
+                off += labels[l].code.size() - pos;
+            }
+            for (uint32_t l = 0; l < labels.size(); l++) {
+                for (LayoutEvent &event : layouts[s][l].events) {
+                    if (event.align || !event.is_short) continue;
+                    const Fixup &fixup = labels[l].fixups[event.fixup];
+                    LabelRef target = label_refs[fixup.target];
+                    int64_t disp = (int64_t)layouts[s][target.label].addr + fixup.addend + 4
+                        - (int64_t)(event.addr + SHORT_JUMP_LEN);
+                    if (!FitsInt8(disp)) {
+                        event.is_short = false;
+                        changed = true;
+                    }
+                }
+            }
+        }
+    }
+
+    std::vector<PendingFixup> pending;
+    for (uint16_t s = 0; s < content.sections.size(); s++) {
+        Section &section = content.sections[s];
+        ObjectSection out;
+        out.name = section.name;
+        out.exec = section.name == ".text";
+        out.write = section.name == ".data" || section.name == ".bss";
+        uint8_t fill = out.exec ? 0x90 : 0x00;
+        for (uint32_t l = 0; l < section.labels.size(); l++) {
+            Label &label = section.labels[l];
+            std::vector<uint8_t> &data = out.data;
+            uint32_t pos = 0;
+            uint32_t f = 0;
+            // Copies raw code up to `end`, carrying the fixups inside it
+            auto copy = [&](uint32_t end) {
+                uint64_t base = data.size();
+                data.insert(data.end(), label.code.begin() + pos, label.code.begin() + end);
+                for (; f < label.fixups.size() && label.fixups[f].offset < end; f++) {
+                    pending.push_back({s, base + label.fixups[f].offset - pos, &label.fixups[f]});
+                }
+                pos = end;
+            };
+            for (LayoutEvent &event : layouts[s][l].events) {
+                copy(event.start);
+                if (event.align) {
+                    if (event.align > out.align) out.align = event.align;
+                    while (data.size() % event.align) data.push_back(fill);
+                    continue;
+                }
+                if (event.is_short) {
+                    const Fixup &fixup = label.fixups[event.fixup];
+                    LabelRef target = label_refs[fixup.target];
+                    int64_t disp = (int64_t)layouts[s][target.label].addr + fixup.addend + 4
+                        - (int64_t)(event.addr + SHORT_JUMP_LEN);
+                    uint8_t op = label.code[event.start + event.op_len - 1];
+                    data.push_back(event.op_len == 1 ? 0xEB : 0x70 + (op & 0x0F));
+                    data.push_back((uint8_t)disp);
+                    pos = event.start + event.op_len + 4;
+                    f = event.fixup + 1;
+                } else {
+                    copy(event.start + event.op_len + 4);
+                }
+            }
+            copy(label.code.size());
+        }
+        image.sections.push_back(out);
+    }
+
+    // Symbols: one per section, then every label that isn't assembler local
+    for (uint16_t s = 0; s < image.sections.size(); s++) {
+        image.symbols.push_back({image.sections[s].name, s, 0, false, true});
+    }
+    std::unordered_map<std::string, uint32_t> symbol_ids;
+    for (uint16_t s = 0; s < content.sections.size(); s++) {
+        for (uint32_t l = 0; l < content.sections[s].labels.size(); l++) {
+            Label &label = content.sections[s].labels[l];
+            if (label.name.rfind(".L", 0) == 0) continue;
+            symbol_ids[label.name] = image.symbols.size();
+            image.symbols.push_back({
+                label.name, s, layouts[s][l].addr, this->globals.count(label.name) > 0, false
+            });
+        }
+    }
+    auto undefined = [&](const std::string &name) {
+        auto it = symbol_ids.find(name);
+        if (it != symbol_ids.end()) return it->second;
+        symbol_ids[name] = image.symbols.size();
+        image.symbols.push_back({name, -1, 0, true, false});
+        return (uint32_t)image.symbols.size() - 1;
+    };
+    for (const std::string &name : this->globals) {
+        if (label_refs.find(name) == label_refs.end()) undefined(name);
+    }
+
+    for (PendingFixup &p : pending) {
+        const Fixup &fixup = *p.fixup;
+        uint8_t *field = image.sections[p.section].data.data() + p.at;
+        auto target = label_refs.find(fixup.target);
+        uint64_t target_addr = 0;
+        if (target != label_refs.end()) {
+            target_addr = layouts[target->second.section][target->second.label].addr;
+        }
+        if (fixup.kind != Fixup::ABS32S && target != label_refs.end() && target->second.section == p.section) {
+            int64_t rel = (int64_t)target_addr + fixup.addend - (int64_t)p.at;
+            if (!FitsInt32(rel)) return false;
+            int32_t value = rel;
+            memcpy(field, &value, 4);
+            continue;
+        }
+        ObjectReloc reloc;
+        reloc.section = p.section;
+        reloc.offset = p.at;
+        reloc.addend = fixup.addend;
+        switch (fixup.kind) {
+            case Fixup::REL32:
+                reloc.type = R_X86_64_PC32;
+                break;
+            case Fixup::BRANCH32:
+            case Fixup::JUMP32:
+                reloc.type = target == label_refs.end() ? R_X86_64_PLT32 : R_X86_64_PC32;
+                break;
+            case Fixup::ABS32S:
+                reloc.type = R_X86_64_32S;
+                break;
+        }
+        if (target == label_refs.end()) {
+            reloc.symbol = undefined(fixup.target);
+        } else if (this->globals.count(fixup.target)) {
+            reloc.symbol = symbol_ids[fixup.target];
+        } else {
+            reloc.symbol = target->second.section;
+            reloc.addend += target_addr;
+        }
+        image.relocs.push_back(reloc);
+    }
+    return true;
+}
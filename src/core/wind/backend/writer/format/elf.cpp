@@ -0,0 +1,341 @@
+/**
+ * @file elf.cpp
+ * @brief Serialization of object images into ELF64 relocatable files.
+ */
+
+#include <wind/backend/writer/format/elf.h>
+#include <elf.h>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+/**
+ * @brief Appends a raw structure to a buffer.
+ */
+template <typename T>
+static void Put(std::string &out, const T &value) {
+    out.append((const char*)&value, sizeof(T));
+}
+
+/**
+ * @brief Pads a buffer up to the given alignment.
+ */
+static void PadTo(std::string &out, uint64_t align) {
+    if (align > 1 && out.size() % align) {
+        out.append(align - out.size() % align, '\0');
+    }
+}
+
+/**
+ * @brief Adds a name to a string table.
+ * @return The offset of the name in the table.
+ */
+static uint32_t AddName(std::string &table, const std::string &name) {
+    uint32_t offset = table.size();
+    table += name;
+    table += '\0';
+    return offset;
+}
+
+/**
+ * @brief Emits the image as an ELF64 relocatable object.
+ * @return The content of the object file.
+ *
+ * Layout: header, section contents, then the section header table.
+ * Sections are numbered null, image sections, .rela.*, .symtab, .strtab,
+ * .shstrtab and .note.GNU-stack.
+ */
+std::string WindElfWriter::Emit() {
+    std::string shstrtab(1, '\0');
+    std::string strtab(1, '\0');
+    std::vector<Elf64_Shdr> headers(1);
+    std::string out(sizeof(Elf64_Ehdr), '\0');
+
+    // Symbols: locals first as required by sh_info
+    std::vector<uint32_t> sym_index(this->image.symbols.size());
+    std::vector<Elf64_Sym> symtab(1);
+    memset(&symtab[0], 0, sizeof(Elf64_Sym));
+    uint32_t first_global = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        if (pass == 1) {
+            first_global = symtab.size();
+        }
+        for (size_t i = 0; i < this->image.symbols.size(); i++) {
+            ObjectSymbol &sym = this->image.symbols[i];
+            if (sym.global != (pass == 1)) continue;
+            Elf64_Sym esym;
+            memset(&esym, 0, sizeof(esym));
+            esym.st_name = sym.is_section ? 0 : AddName(strtab, sym.name);
+            esym.st_info = ELF64_ST_INFO(
+                sym.global ? STB_GLOBAL : STB_LOCAL,
+                sym.is_section ? STT_SECTION : STT_NOTYPE
+            );
+            esym.st_shndx = sym.section < 0 ? SHN_UNDEF : sym.section + 1;
+            esym.st_value = sym.value;
+            sym_index[i] = symtab.size();
+            symtab.push_back(esym);
+        }
+    }
+
+    for (ObjectSection &section : this->image.sections) {
+        PadTo(out, section.align);
+        Elf64_Shdr hdr;
+        memset(&hdr, 0, sizeof(hdr));
+        hdr.sh_name = AddName(shstrtab, section.name);
+        hdr.sh_type = SHT_PROGBITS;
+        hdr.sh_flags = SHF_ALLOC | (section.write ? SHF_WRITE : 0) | (section.exec ? SHF_EXECINSTR : 0);
+        hdr.sh_offset = out.size();
+        hdr.sh_size = section.data.size();
+        hdr.sh_addralign = section.align;
+        out.append((const char*)section.data.data(), section.data.size());
+        headers.push_back(hdr);
+    }
+
+    uint16_t n_sections = this->image.sections.size();
+    uint16_t symtab_idx = 0;
+    std::vector<std::pair<uint16_t, std::vector<Elf64_Rela>>> relas;
+    for (uint16_t s = 0; s < n_sections; s++) {
+        std::vector<Elf64_Rela> entries;
+        for (ObjectReloc &reloc : this->image.relocs) {
+            if (reloc.section != s) continue;
+            Elf64_Rela rela;
+            rela.r_offset = reloc.offset;
+            rela.r_info = ELF64_R_INFO(sym_index[reloc.symbol], reloc.type);
+            rela.r_addend = reloc.addend;
+            entries.push_back(rela);
+        }
+        if (!entries.empty()) {
+            relas.push_back({s, entries});
+        }
+    }
+    symtab_idx = 1 + n_sections + relas.size();
+
+    for (auto &rela : relas) {
+        PadTo(out, 8);
+        Elf64_Shdr hdr;
+        memset(&hdr, 0, sizeof(hdr));
+        hdr.sh_name = AddName(shstrtab, ".rela" + this->image.sections[rela.first].name);
+        hdr.sh_type = SHT_RELA;
+        hdr.sh_flags = SHF_INFO_LINK;
+        hdr.sh_offset = out.size();
+        hdr.sh_size = rela.second.size() * sizeof(Elf64_Rela);
+        hdr.sh_link = symtab_idx;
+        hdr.sh_info = rela.first + 1;
+        hdr.sh_addralign = 8;
+        hdr.sh_entsize = sizeof(Elf64_Rela);
+        for (Elf64_Rela &entry : rela.second) {
+            Put(out, entry);
+        }
+        headers.push_back(hdr);
+    }
+
+    PadTo(out, 8);
+    Elf64_Shdr sym_hdr;
+    memset(&sym_hdr, 0, sizeof(sym_hdr));
+    sym_hdr.sh_name = AddName(shstrtab, ".symtab");
+    sym_hdr.sh_type = SHT_SYMTAB;
+    sym_hdr.sh_offset = out.size();
+    sym_hdr.sh_size = symtab.size() * sizeof(Elf64_Sym);
+    sym_hdr.sh_link = symtab_idx + 1;
+    sym_hdr.sh_info = first_global;
+    sym_hdr.sh_addralign = 8;
+    sym_hdr.sh_entsize = sizeof(Elf64_Sym);
+    for (Elf64_Sym &sym : symtab) {
+        Put(out, sym);
+    }
+    headers.push_back(sym_hdr);
+
+    Elf64_Shdr str_hdr;
+    memset(&str_hdr, 0, sizeof(str_hdr));
+    str_hdr.sh_name = AddName(shstrtab, ".strtab");
+    str_hdr.sh_type = SHT_STRTAB;
+    str_hdr.sh_offset = out.size();
+    str_hdr.sh_size = strtab.size();
+    str_hdr.sh_addralign = 1;
+    out += strtab;
+    headers.push_back(str_hdr);
+
+    // Marks the stack as non executable for the linker
+    Elf64_Shdr note_hdr;
+    memset(&note_hdr, 0, sizeof(note_hdr));
+    note_hdr.sh_name = AddName(shstrtab, ".note.GNU-stack");
+    note_hdr.sh_type = SHT_PROGBITS;
+    note_hdr.sh_addralign = 1;
+
+    Elf64_Shdr shstr_hdr;
+    memset(&shstr_hdr, 0, sizeof(shstr_hdr));
+    shstr_hdr.sh_name = AddName(shstrtab, ".shstrtab");
+    shstr_hdr.sh_type = SHT_STRTAB;
+    shstr_hdr.sh_offset = out.size();
+    shstr_hdr.sh_size = shstrtab.size();
+    shstr_hdr.sh_addralign = 1;
+    out += shstrtab;
+    headers.push_back(shstr_hdr);
+    note_hdr.sh_offset = out.size();
+    headers.push_back(note_hdr);
+
+    PadTo(out, 8);
+    Elf64_Ehdr ehdr;
+    memset(&ehdr, 0, sizeof(ehdr));
+    memcpy(ehdr.e_ident, ELFMAG, SELFMAG);
+    ehdr.e_ident[EI_CLASS] = ELFCLASS64;
+    ehdr.e_ident[EI_DATA] = ELFDATA2LSB;
+    ehdr.e_ident[EI_VERSION] = EV_CURRENT;
+    ehdr.e_ident[EI_OSABI] = ELFOSABI_NONE;
+    ehdr.e_type = ET_REL;
+    ehdr.e_machine = EM_X86_64;
+    ehdr.e_version = EV_CURRENT;
+    ehdr.e_shoff = out.size();
+    ehdr.e_ehsize = sizeof(Elf64_Ehdr);
+    ehdr.e_shentsize = sizeof(Elf64_Shdr);
+    ehdr.e_shnum = headers.size();
+    ehdr.e_shstrndx = headers.size() - 2;
+    memset(&headers[0], 0, sizeof(Elf64_Shdr));
+    for (Elf64_Shdr &hdr : headers) {
+        Put(out, hdr);
+    }
+    memcpy(&out[0], &ehdr, sizeof(ehdr));
+    return out;
+}
+
+/**
+ * @brief Writes the ELF object to a file.
+ * @param path The output path.
+ * @return True on success.
+ */
+bool WindElfWriter::Write(std::string path) {
+    std::string content = this->Emit();
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+    file.write(content.data(), content.size());
+    return file.good();
+}
+
+/**
+ * @brief Parses an ELF64 relocatable object into the image.
+ * @param content The content of the object file.
+ * @return False if the object is malformed or not x86-64 ET_REL.
+ *
+ * Only allocated sections are kept; .bss style sections become zero filled
+ * data. Symbols and relocations keep their ELF order, so symbol indices of
+ * the relocations map one to one.
+ */
+bool WindElfReader::Parse(const std::string &content) {
+    if (content.size() < sizeof(Elf64_Ehdr)) {
+        return false;
+    }
+    Elf64_Ehdr ehdr;
+    memcpy(&ehdr, content.data(), sizeof(ehdr));
+    if (memcmp(ehdr.e_ident, ELFMAG, SELFMAG) != 0 ||
+        ehdr.e_ident[EI_CLASS] != ELFCLASS64 ||
+        ehdr.e_type != ET_REL || ehdr.e_machine != EM_X86_64 ||
+        ehdr.e_shentsize != sizeof(Elf64_Shdr) ||
+        ehdr.e_shoff + (uint64_t)ehdr.e_shnum * sizeof(Elf64_Shdr) > content.size()) {
+        return false;
+    }
+    std::vector<Elf64_Shdr> headers(ehdr.e_shnum);
+    memcpy(headers.data(), content.data() + ehdr.e_shoff, ehdr.e_shnum * sizeof(Elf64_Shdr));
+    for (Elf64_Shdr &hdr : headers) {
+        if (hdr.sh_type != SHT_NOBITS && hdr.sh_offset + hdr.sh_size > content.size()) {
+            return false;
+        }
+    }
+    auto Name = [&](uint32_t table, uint32_t offset) -> std::string {
+        if (table >= headers.size() || offset >= headers[table].sh_size) return "";
+        const char *str = content.data() + headers[table].sh_offset + offset;
+        return std::string(str, strnlen(str, headers[table].sh_size - offset));
+    };
+
+    std::vector<int32_t> section_map(headers.size(), -1);
+    for (size_t i = 1; i < headers.size(); i++) {
+        Elf64_Shdr &hdr = headers[i];
+        if (!(hdr.sh_flags & SHF_ALLOC) || (hdr.sh_type != SHT_PROGBITS && hdr.sh_type != SHT_NOBITS)) {
+            continue;
+        }
+        ObjectSection section;
+        section.name = Name(ehdr.e_shstrndx, hdr.sh_name);
+        section.align = hdr.sh_addralign ? hdr.sh_addralign : 1;
+        section.write = hdr.sh_flags & SHF_WRITE;
+        section.exec = hdr.sh_flags & SHF_EXECINSTR;
+        if (hdr.sh_type == SHT_NOBITS) {
+            section.data.assign(hdr.sh_size, 0);
+        } else {
+            const uint8_t *data = (const uint8_t*)content.data() + hdr.sh_offset;
+            section.data.assign(data, data + hdr.sh_size);
+        }
+        section_map[i] = this->image.sections.size();
+        this->image.sections.push_back(section);
+    }
+
+    uint32_t symtab = 0;
+    for (size_t i = 1; i < headers.size(); i++) {
+        if (headers[i].sh_type == SHT_SYMTAB) {
+            symtab = i;
+            break;
+        }
+    }
+    if (symtab) {
+        Elf64_Shdr &hdr = headers[symtab];
+        size_t count = hdr.sh_size / sizeof(Elf64_Sym);
+        for (size_t i = 0; i < count; i++) {
+            Elf64_Sym esym;
+            memcpy(&esym, content.data() + hdr.sh_offset + i * sizeof(Elf64_Sym), sizeof(esym));
+            ObjectSymbol sym;
+            sym.is_section = ELF64_ST_TYPE(esym.st_info) == STT_SECTION;
+            sym.name = sym.is_section ? "" : Name(hdr.sh_link, esym.st_name);
+            sym.global = ELF64_ST_BIND(esym.st_info) != STB_LOCAL;
+            sym.value = esym.st_value;
+            sym.section = esym.st_shndx < headers.size() ? section_map[esym.st_shndx] : -1;
+            if (esym.st_shndx != SHN_UNDEF && sym.section < 0 && !sym.global) {
+                // Symbols of dropped sections (files, notes) are never referenced
+                sym.name = "";
+            }
+            this->image.symbols.push_back(sym);
+        }
+    }
+
+    for (size_t i = 1; i < headers.size(); i++) {
+        Elf64_Shdr &hdr = headers[i];
+        if (hdr.sh_type == SHT_REL) {
+            return false;
+        }
+        if (hdr.sh_type != SHT_RELA || hdr.sh_info >= headers.size() || section_map[hdr.sh_info] < 0) {
+            continue;
+        }
+        if (hdr.sh_link != symtab) {
+            return false;
+        }
+        size_t count = hdr.sh_size / sizeof(Elf64_Rela);
+        for (size_t r = 0; r < count; r++) {
+            Elf64_Rela rela;
+            memcpy(&rela, content.data() + hdr.sh_offset + r * sizeof(Elf64_Rela), sizeof(rela));
+            if (ELF64_R_SYM(rela.r_info) >= this->image.symbols.size()) {
+                return false;
+            }
+            ObjectReloc reloc;
+            reloc.section = section_map[hdr.sh_info];
+            reloc.offset = rela.r_offset;
+            reloc.type = ELF64_R_TYPE(rela.r_info);
+            reloc.symbol = ELF64_R_SYM(rela.r_info);
+            reloc.addend = rela.r_addend;
+            this->image.relocs.push_back(reloc);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Reads an ELF object from a file.
+ * @param path The object path.
+ * @return True on success.
+ */
+bool WindElfReader::Read(std::string path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return this->Parse(content);
+}
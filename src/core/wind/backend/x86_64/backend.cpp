@@ -9,8 +9,8 @@
 #include <wind/bridge/flags.h>
 #include <wind/processing/utils.h>
 #include <wind/backend/interface/gas.h>
+#include <wind/backend/writer/format/elf.h>
 #include <stdexcept>
-#include <fstream>
 
 Reg WindEmitter::CastReg(Reg reg, uint8_t size) {
     if (reg.size == size) return reg;
@@ -93,16 +93,47 @@ void WindEmitter::Process() {
 }
 
 
+/**
+ * @brief Emits the object file for the processed program.
+ * @param outpath The output path, a temporary one if empty.
+ * @return The path to the object file.
+ *
+ * Binary emitters write the ELF object directly. When the program holds
+ * something the encoder can't take (inline assembly), or the object can't
+ * be written, it is emitted again as text and handed to `as`.
+ */
 std::string WindEmitter::emitObj(std::string outpath) {
-  std::string outemit = this->GetAsm();
-  std::string path = generateRandomFilePath("", ".S");
-  std::ofstream file(path);
-  if (file.is_open()) {
-    file << outemit;
-    file.close();
+  if (this->binary) {
+    ObjectImage image;
+    if (((Bx86_64*)this->writer)->Link(image)) {
+      if (outpath == "") {
+        outpath = generateRandomFilePath("", ".o");
+      }
+      WindElfWriter elf(image);
+      if (elf.Write(outpath)) {
+        return outpath;
+      }
+      // as reports why the object can't be written
+    }
+    WindEmitter *text = new WindEmitter(this->program);
+    text->Process();
+    std::string ret = text->emitObj(outpath);
+    delete text;
+    return ret;
   }
-  WindGasInterface *gas = new WindGasInterface(path, outpath);
+  WindGasInterface *gas = new WindGasInterface(this->GetAsm(), outpath);
   gas->addFlag("-O3");
   std::string ret = gas->assemble();
+  delete gas;
   return ret;
+}
+
+/**
+ * @brief Links the processed program into an in-memory object image.
+ * @param image Filled with the linked sections, symbols and relocations.
+ * @return False if the emitter is not binary or the encoder can't take the
+ * program, in which case emitObj must be used instead.
+ */
+bool WindEmitter::emitImage(ObjectImage &image) {
+  return this->binary && ((Bx86_64*)this->writer)->Link(image);
 }
\ No newline at end of file
@@ -0,0 +1,128 @@
+/**
+ * @file arena.cpp
+ * @brief Arena allocation of the AST nodes.
+ */
+
+#include <wind/bridge/arena.h>
+#include <wind/bridge/ast.h>
+#include <stdint.h>
+#include <new>
+
+#define ARENA_BLOCK_SIZE (64 * 1024)
+
+// Every node is preceded by its record header, the arena walks the records
+// to run the pending destructors and operator delete uses it to tell heap
+// nodes apart
+struct NodeHeader {
+  uint32_t size; // of the whole record, header included
+  uint32_t state;
+};
+
+enum NodeState : uint32_t {
+  NODE_HEAP,
+  NODE_LIVE,
+  NODE_DEAD
+};
+
+static thread_local ASTArena *current_arena = nullptr;
+
+/**
+ * @brief Destructor for ASTArena, destroys the nodes still alive and frees the blocks.
+ */
+ASTArena::~ASTArena() {
+  for (Block &block : this->blocks) {
+    size_t offset = 0;
+    while (offset < block.used) {
+      NodeHeader *header = (NodeHeader*)(block.data + offset);
+      if (header->state == NODE_LIVE) {
+        header->state = NODE_DEAD;
+        ((ASTNode*)(header + 1))->~ASTNode();
+      }
+      offset += header->size;
+    }
+  }
+  for (Block &block : this->blocks) {
+    ::operator delete(block.data);
+  }
+}
+
+/**
+ * @brief Bumps a record out of the last block, opening a block if needed.
+ * @param size The record size, a multiple of 8.
+ */
+void *ASTArena::allocate(size_t size) {
+  if (this->blocks.empty() || this->blocks.back().size - this->blocks.back().used < size) {
+    size_t block_size = size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE;
+    this->blocks.push_back({(char*)::operator new(block_size), block_size, 0});
+  }
+  Block &block = this->blocks.back();
+  void *ptr = block.data + block.used;
+  block.used += size;
+  return ptr;
+}
+
+/**
+ * @brief Takes over the blocks of another arena, its nodes now go away with this one.
+ * @param other The arena, deleted.
+ */
+void ASTArena::adopt(ASTArena *other) {
+  // Allocation continues in the last block of this arena
+  this->blocks.insert(this->blocks.begin(), other->blocks.begin(), other->blocks.end());
+  other->blocks.clear();
+  delete other;
+}
+
+/**
+ * @brief Gets the bytes taken by the nodes of the arena.
+ */
+size_t ASTArena::used() const {
+  size_t used = 0;
+  for (const Block &block : this->blocks) {
+    used += block.used;
+  }
+  return used;
+}
+
+/**
+ * @brief Gets the arena nodes of this thread go to, nullptr for the heap.
+ */
+ASTArena *ASTArena::Current() {
+  return current_arena;
+}
+
+/**
+ * @brief Allocates the nodes of this thread in an arena until the scope ends.
+ * @param arena The arena, nullptr to go back to the heap.
+ */
+ASTArena::Scope::Scope(ASTArena *arena) : previous(current_arena) {
+  current_arena = arena;
+}
+
+ASTArena::Scope::~Scope() {
+  current_arena = this->previous;
+}
+
+/**
+ * @brief Allocates a node in the current arena, or on the heap without one.
+ */
+void *ASTNode::operator new(size_t size) {
+  static_assert(sizeof(NodeHeader) == 8, "Nodes must stay 8-byte aligned");
+  size_t record = (sizeof(NodeHeader) + size + 7) & ~(size_t)7;
+  ASTArena *arena = current_arena;
+  NodeHeader *header = (NodeHeader*)(arena ? arena->allocate(record) : ::operator new(record));
+  header->size = record;
+  header->state = arena ? NODE_LIVE : NODE_HEAP;
+  return header + 1;
+}
+
+/**
+ * @brief Frees a heap node, an arena node is only marked as destroyed.
+ */
+void ASTNode::operator delete(void *ptr) {
+  NodeHeader *header = (NodeHeader*)ptr - 1;
+  if (header->state == NODE_HEAP) {
+    ::operator delete(header);
+  } else {
+    header->state = NODE_DEAD;
+  }
+}
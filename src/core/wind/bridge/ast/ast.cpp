@@ -3,7 +3,7 @@
 
 // BinaryExpr
 
-BinaryExpr::BinaryExpr(std::unique_ptr<ASTNode> l, std::unique_ptr<ASTNode> r, std::string o)
+BinaryExpr::BinaryExpr(ASTPtr<ASTNode> l, ASTPtr<ASTNode> r, std::string o)
   : left(std::move(l)), right(std::move(r)), op(o) {}
 
 void *BinaryExpr::accept(ASTVisitor &visitor) const {
@@ -64,7 +64,7 @@ int Literal::get() const {
 
 // Return
 
-Return::Return(std::unique_ptr<ASTNode> v) : value(std::move(v)) {}
+Return::Return(ASTPtr<ASTNode> v) : value(std::move(v)) {}
 
 void *Return::accept(ASTVisitor &visitor) const {
   return visitor.visit(*this);
@@ -81,24 +81,30 @@ void *Body::accept(ASTVisitor &visitor) const {
   return visitor.visit(*this);
 }
 
-Body::Body(std::vector<std::unique_ptr<ASTNode>> s) : statements(std::move(s)) {}
+Body::Body(std::vector<ASTPtr<ASTNode>> s) : statements(std::move(s)) {}
 
-const std::vector<std::unique_ptr<ASTNode>>& Body::get() const {
+const std::vector<ASTPtr<ASTNode>>& Body::get() const {
   return statements;
 }
 
-Body& Body::operator + (std::unique_ptr<ASTNode> statement) {
+std::vector<ASTPtr<ASTNode>> Body::take() {
+  std::vector<ASTPtr<ASTNode>> taken;
+  taken.swap(statements);
+  return taken;
+}
+
+Body& Body::operator + (ASTPtr<ASTNode> statement) {
   statements.push_back(std::move(statement));
   return *this;
 }
 
-Body& Body::operator += (std::unique_ptr<ASTNode> statement) {
+Body& Body::operator += (ASTPtr<ASTNode> statement) {
   return *this + std::move(statement);
 }
 
 // Function
 
-Function::Function(std::string name, std::string type, std::unique_ptr<Body> body) : fn_name(name), return_type(type), body(std::move(body)) {}
+Function::Function(std::string name, const TypeExpr *type, ASTPtr<Body> body) : fn_name(name), return_type(type), body(std::move(body)) {}
 
 void *Function::accept(ASTVisitor &visitor) const {
   return visitor.visit(*this);
@@ -112,19 +118,19 @@ const Body* Function::getBody() const {
   return body.get();
 }
 
-const std::string& Function::getType() const {
+const TypeExpr *Function::getType() const {
   return return_type;
 }
 
-void Function::copyArgTypes(std::vector<std::string>& types) {
+void Function::copyArgTypes(std::vector<const TypeExpr*>& types) {
   arg_types = types;
 }
 
-std::vector<std::string> Function::getArgTypes() const {
+const std::vector<const TypeExpr*> &Function::getArgTypes() const {
   return arg_types;
 }
 
-VariableDecl::VariableDecl(std::vector<std::string> names, std::string type, std::unique_ptr<ASTNode> value) : vars(names), type(type), value(std::move(value)) {}
+VariableDecl::VariableDecl(std::vector<std::string> names, const TypeExpr *type, ASTPtr<ASTNode> value) : vars(names), type(type), value(std::move(value)) {}
 
 void *VariableDecl::accept(ASTVisitor &visitor) const {
   return visitor.visit(*this);
@@ -134,7 +140,7 @@ const std::vector<std::string>& VariableDecl::getNames() const {
   return vars;
 }
 
-const std::string& VariableDecl::getType() const {
+const TypeExpr *VariableDecl::getType() const {
   return type;
 }
 
@@ -142,7 +148,7 @@ ASTNode *VariableDecl::getValue() const {
   return value.get();
 }
 
-GlobalDecl::GlobalDecl(std::string name, std::string type, std::unique_ptr<ASTNode> value) : name(name), type(type), value(std::move(value)) {}
+GlobalDecl::GlobalDecl(std::string name, const TypeExpr *type, ASTPtr<ASTNode> value) : name(name), type(type), value(std::move(value)) {}
 
 void *GlobalDecl::accept(ASTVisitor &visitor) const {
   return visitor.visit(*this);
@@ -152,7 +158,7 @@ const std::string& GlobalDecl::getName() const {
   return name;
 }
 
-const std::string& GlobalDecl::getType() const {
+const TypeExpr *GlobalDecl::getType() const {
   return type;
 }
 
@@ -161,7 +167,7 @@ ASTNode *GlobalDecl::getValue() const {
 }
 
 
-ArgDecl::ArgDecl(std::string name, std::string type) : name(name), type(type) {}
+ArgDecl::ArgDecl(std::string name, const TypeExpr *type) : name(name), type(type) {}
 
 void *ArgDecl::accept(ASTVisitor &visitor) const {
   return visitor.visit(*this);
@@ -171,11 +177,11 @@ const std::string& ArgDecl::getName() const {
   return name;
 }
 
-const std::string& ArgDecl::getType() const {
+const TypeExpr *ArgDecl::getType() const {
   return type;
 }
 
-FnCall::FnCall(std::string n, std::vector<std::unique_ptr<ASTNode>> a) : name(n), args(std::move(a)) {}
+FnCall::FnCall(std::string n, std::vector<ASTPtr<ASTNode>> a) : name(n), args(std::move(a)) {}
 
 void *FnCall::accept(ASTVisitor &visitor) const {
   return visitor.visit(*this);
@@ -185,7 +191,7 @@ const std::string& FnCall::getName() const {
   return name;
 }
 
-const std::vector<std::unique_ptr<ASTNode>>& FnCall::getArgs() const {
+const std::vector<ASTPtr<ASTNode>>& FnCall::getArgs() const {
   return args;
 }
 
@@ -205,14 +211,14 @@ const std::string& StringLiteral::getValue() const {
   return str;
 }
 
-TypeDecl::TypeDecl(std::string n, std::string t) : name(n), type(t) {}
+TypeDecl::TypeDecl(std::string n, const TypeExpr *t) : name(n), type(t) {}
 void *TypeDecl::accept(ASTVisitor &visitor) const {
   return visitor.visit(*this);
 }
 const std::string& TypeDecl::getName() const {
   return name;
 }
-const std::string& TypeDecl::getType() const {
+const TypeExpr *TypeDecl::getType() const {
   return type;
 }
 
@@ -225,7 +231,7 @@ const std::vector<Branch>& Branching::getBranches() const {
 const Body* Branching::getElseBranch() const {
   return else_branch;
 }
-void Branching::addBranch(std::unique_ptr<ASTNode> condition, std::unique_ptr<Body> body) {
+void Branching::addBranch(ASTPtr<ASTNode> condition, ASTPtr<Body> body) {
   branches.push_back({std::move(condition), std::move(body)});
 }
 void Branching::setElseBranch(Body* body) {
@@ -258,7 +264,7 @@ void *Continue::accept(ASTVisitor &visitor) const {
   return visitor.visit(*this);
 }
 
-GenericIndexing::GenericIndexing(std::unique_ptr<ASTNode> i, std::unique_ptr<ASTNode> b) {
+GenericIndexing::GenericIndexing(ASTPtr<ASTNode> i, ASTPtr<ASTNode> b) {
   index = std::move(i);
   base = std::move(b);
 }
@@ -272,7 +278,7 @@ const ASTNode *GenericIndexing::getBase() const {
   return base.get();
 }
 
-PtrGuard::PtrGuard(std::unique_ptr<ASTNode> v) : value(std::move(v)) {}
+PtrGuard::PtrGuard(ASTPtr<ASTNode> v) : value(std::move(v)) {}
 void *PtrGuard::accept(ASTVisitor &visitor) const {
   return visitor.visit(*this);
 }
@@ -280,27 +286,27 @@ const ASTNode *PtrGuard::getValue() const {
   return value.get();
 }
 
-TypeCast::TypeCast(std::string t, std::unique_ptr<ASTNode> v) : type(t), value(std::move(v)) {}
+TypeCast::TypeCast(const TypeExpr *t, ASTPtr<ASTNode> v) : type(t), value(std::move(v)) {}
 void *TypeCast::accept(ASTVisitor &visitor) const {
   return visitor.visit(*this);
 }
-const std::string &TypeCast::getType() const {
+const TypeExpr *TypeCast::getType() const {
   return type;
 }
 const ASTNode *TypeCast::getValue() const {
   return value.get();
 }
 
-SizeOf::SizeOf(std::string t) : type(t) {}
+SizeOf::SizeOf(const TypeExpr *t) : type(t) {}
 void *SizeOf::accept(ASTVisitor &visitor) const {
   return visitor.visit(*this);
 }
-const std::string &SizeOf::getType() const {
+const TypeExpr *SizeOf::getType() const {
   return type;
 }
 
 
-TryCatch::TryCatch() {}
+TryCatch::TryCatch() : try_body(nullptr), finally_block(nullptr) {}
 void TryCatch::setTryBody(Body* b) {
   try_body = b;
 }
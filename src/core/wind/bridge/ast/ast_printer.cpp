@@ -66,7 +66,7 @@ void *ASTPrinter::visit(const Function &node) {
 }
 
 void *ASTPrinter::visit(const VariableDecl &node) {
-  std::cout << "decl [" << node.getType() << "] " << node.getNames()[0];
+  std::cout << "decl [" << node.getType()->str() << "] " << node.getNames()[0];
   if (node.getValue()) {
     std::cout << " = ";
     node.getValue()->accept(*this);
@@ -75,7 +75,7 @@ void *ASTPrinter::visit(const VariableDecl &node) {
 }
 
 void *ASTPrinter::visit(const ArgDecl &node) {
-  std::cout << "arg [" << node.getType() << "] " << node.getName();
+  std::cout << "arg [" << node.getType()->str() << "] " << node.getName();
   return nullptr;
 }
 
@@ -104,7 +104,7 @@ void *ASTPrinter::visit(const StringLiteral &node) {
 }
 
 void *ASTPrinter::visit(const TypeDecl &node) {
-  std::cout << "type " << node.getName() << " = " << node.getType() << std::endl;
+  std::cout << "type " << node.getName() << " = " << node.getType()->str() << std::endl;
   return nullptr;
 }
 
@@ -150,7 +150,7 @@ void *ASTPrinter::visit(const Looping &node) {
 }
 
 void *ASTPrinter::visit(const GlobalDecl &node) {
-  std::cout << "global " << node.getName() << " [" << node.getType() << "]" << std::endl;
+  std::cout << "global " << node.getName() << " [" << node.getType()->str() << "]" << std::endl;
   return nullptr;
 }
 
@@ -180,14 +180,14 @@ void *ASTPrinter::visit(const PtrGuard &node) {
 }
 
 void *ASTPrinter::visit(const TypeCast &node) {
-  std::cout << "<" << node.getType() << ">(";
+  std::cout << "<" << node.getType()->str() << ">(";
   node.getValue()->accept(*this);
   std::cout << ")";
   return nullptr;
 }
 
 void *ASTPrinter::visit(const SizeOf &node) {
-  std::cout << "sizeof<" << node.getType() << ">";
+  std::cout << "sizeof<" << node.getType()->str() << ">";
   return nullptr;
 }
 
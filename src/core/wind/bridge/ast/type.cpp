@@ -0,0 +1,83 @@
+/**
+ * @file type.cpp
+ * @brief Interned type expressions.
+ */
+
+#include <wind/bridge/type.h>
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+static std::mutex table_mutex;
+static std::unordered_map<std::string, TypeExpr*> named_types;
+static std::unordered_map<const TypeExpr*, TypeExpr*> pointer_types;
+static std::map<std::pair<const TypeExpr*, uint32_t>, TypeExpr*> array_types;
+
+/**
+ * @brief Gets the source spelling of a type.
+ */
+std::string TypeExpr::str() const {
+  switch (this->kind) {
+    case TypeExpr::POINTER:
+      return "ptr<" + this->inner->str() + ">";
+    case TypeExpr::ARRAY:
+      if (this->capacity) {
+        return "[" + this->inner->str() + ";" + std::to_string(this->capacity) + "]";
+      }
+      return "[" + this->inner->str() + "]";
+    default:
+      return this->spelling;
+  }
+}
+
+/**
+ * @brief Interns a named type.
+ * @param spelling The words of the type, separated by a space.
+ */
+const TypeExpr *TypeTable::Named(const std::string &spelling) {
+  std::lock_guard<std::mutex> lock(table_mutex);
+  TypeExpr *&type = named_types[spelling];
+  if (!type) {
+    type = new TypeExpr();
+    type->kind = TypeExpr::NAMED;
+    type->spelling = spelling;
+    type->is_unsigned = spelling.find("unsigned") != std::string::npos;
+    size_t sf = spelling.find(' ');
+    type->name = spelling.substr(sf != std::string::npos ? sf + 1 : 0);
+    type->name.erase(std::remove(type->name.begin(), type->name.end(), ' '), type->name.end());
+  }
+  return type;
+}
+
+/**
+ * @brief Interns a pointer type.
+ * @param inner The pointed type, interned.
+ */
+const TypeExpr *TypeTable::Pointer(const TypeExpr *inner) {
+  std::lock_guard<std::mutex> lock(table_mutex);
+  TypeExpr *&type = pointer_types[inner];
+  if (!type) {
+    type = new TypeExpr();
+    type->kind = TypeExpr::POINTER;
+    type->inner = inner;
+  }
+  return type;
+}
+
+/**
+ * @brief Interns an array type.
+ * @param inner The element type, interned.
+ * @param capacity The element count, 0 when unsized.
+ */
+const TypeExpr *TypeTable::Array(const TypeExpr *inner, uint32_t capacity) {
+  std::lock_guard<std::mutex> lock(table_mutex);
+  TypeExpr *&type = array_types[{inner, capacity}];
+  if (!type) {
+    type = new TypeExpr();
+    type->kind = TypeExpr::ARRAY;
+    type->inner = inner;
+    type->capacity = capacity;
+  }
+  return type;
+}
@@ -0,0 +1,213 @@
+/**
+ * @file cache.cpp
+ * @brief Implementation of the content-addressed object cache.
+ */
+
+#include <wind/cache/cache.h>
+#include <wind/processing/utils.h>
+#include <wind/processing/source.h>
+
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+#ifndef WIND_VERSION
+#define WIND_VERSION "unknown"
+#endif
+
+#define CACHE_MANIFEST_MAGIC "windc-cache 1"
+
+/**
+ * @brief Hashes a buffer with 128-bit FNV-1a.
+ * @param data The data to hash.
+ * @return The hash as a lowercase hex string.
+ */
+std::string hashContent(std::string_view data) {
+  const unsigned __int128 prime = ((unsigned __int128)1 << 88) | 0x13b;
+  unsigned __int128 hash = ((unsigned __int128)0x6c62272e07bb0142ULL << 64) | 0x62b821756295c58dULL;
+  for (unsigned char c : data) {
+    hash ^= c;
+    hash *= prime;
+  }
+  static const char digits[] = "0123456789abcdef";
+  std::string out(32, '0');
+  for (int i = 31; i >= 0; i--) {
+    out[i] = digits[(uint8_t)(hash & 0xf)];
+    hash >>= 4;
+  }
+  return out;
+}
+
+/**
+ * @brief Hashes the content of a file.
+ * @param path The file to hash.
+ * @return The hash, or an empty string if the file can't be read.
+ */
+std::string hashFile(const std::string &path) {
+  SourceBuffer *source = SourceBuffer::Map(path.c_str());
+  if (!source) {
+    return "";
+  }
+  std::string hash = hashContent(source->view());
+  delete source;
+  return hash;
+}
+
+/**
+ * @brief Constructor for WindObjectCache.
+ * @param dir The directory holding the cache entries.
+ *
+ * The compiler identity is the version plus the size and mtime of the running
+ * executable, so rebuilding windc invalidates every entry.
+ */
+WindObjectCache::WindObjectCache(std::string dir) : dir(dir) {
+  std::error_code ec;
+  std::filesystem::create_directories(dir, ec);
+  this->compiler_id = WIND_VERSION;
+  std::filesystem::path exe("/proc/self/exe");
+  uintmax_t size = std::filesystem::file_size(exe, ec);
+  if (!ec) {
+    this->compiler_id += ":" + std::to_string(size);
+  }
+  auto mtime = std::filesystem::last_write_time(exe, ec);
+  if (!ec) {
+    this->compiler_id += ":" + std::to_string(mtime.time_since_epoch().count());
+  }
+}
+
+/**
+ * @brief Gets the default cache directory.
+ * @return $WIND_CACHE_DIR, else $XDG_CACHE_HOME/windc, else ~/.cache/windc.
+ */
+std::string WindObjectCache::defaultDir() {
+  if (const char *env = std::getenv("WIND_CACHE_DIR")) {
+    return env;
+  }
+  if (const char *xdg = std::getenv("XDG_CACHE_HOME")) {
+    return std::string(xdg) + "/windc";
+  }
+  if (const char *home = std::getenv("HOME")) {
+    return std::string(home) + "/.cache/windc";
+  }
+  return std::filesystem::temp_directory_path().string() + "/windc-cache";
+}
+
+/**
+ * @brief Computes the primary key of a source file.
+ * @param path The path to the source file.
+ * @param flags The emission flags the file is compiled with.
+ * @return The key, or an empty string if the source can't be read.
+ *
+ * Interfaces pulled in by the source are only known after parsing, so they
+ * are checked against the manifest stored under this key.
+ */
+std::string WindObjectCache::key(const std::string &path, uint32_t flags) {
+  std::string source = hashFile(path);
+  if (source.empty()) {
+    return "";
+  }
+  return hashContent(
+    this->compiler_id + "\n" + std::to_string(flags) + "\n" + getRealPath(path) + "\n" + source
+  );
+}
+
+/**
+ * @brief Gets where the precompiled image of an interface is kept.
+ * @param path The real path of the interface.
+ * @return The image file, specific to this compiler.
+ */
+std::string WindObjectCache::interfaceImage(const std::string &path) {
+  return this->dir + "/" + hashContent(this->compiler_id + "\n" + path) + ".wic";
+}
+
+/**
+ * @brief Looks up an entry whose dependencies are all unchanged.
+ * @param key The primary key of the source.
+ * @param entry Filled with the cached object and its metadata on a hit.
+ * @return True on a hit.
+ */
+bool WindObjectCache::lookup(const std::string &key, CacheEntry &entry) {
+  if (key.empty()) {
+    return false;
+  }
+  std::string base = this->dir + "/" + key;
+  std::ifstream manifest(base + ".manifest");
+  if (!manifest.is_open()) {
+    return false;
+  }
+  std::string line;
+  if (!std::getline(manifest, line) || line != CACHE_MANIFEST_MAGIC) {
+    return false;
+  }
+  while (std::getline(manifest, line)) {
+    size_t sp = line.find(' ');
+    if (sp == std::string::npos) {
+      return false;
+    }
+    std::string kind = line.substr(0, sp);
+    std::string value = line.substr(sp + 1);
+    if (kind == "dep") {
+      size_t psp = value.find(' ');
+      if (psp == std::string::npos || hashFile(value.substr(psp + 1)) != value.substr(0, psp)) {
+        return false;
+      }
+    } else if (kind == "ldflag") {
+      entry.ld_flags.push_back(value);
+    } else if (kind == "import") {
+      entry.imports.push_back(value);
+    }
+  }
+  entry.object = base + ".o";
+  return std::filesystem::exists(entry.object);
+}
+
+/**
+ * @brief Stores a freshly compiled object.
+ * @param key The primary key of the source.
+ * @param object The object file produced for the source.
+ * @param deps Every interface the source pulled in.
+ * @param ld_flags Link flags requested by the source.
+ * @param imports Package sources the source imports.
+ *
+ * Files are written under a temporary name and renamed, so concurrent windc
+ * processes never observe a half written entry.
+ */
+void WindObjectCache::store(
+  const std::string &key,
+  const std::string &object,
+  const std::vector<std::string> &deps,
+  const std::vector<std::string> &ld_flags,
+  const std::vector<std::string> &imports
+) {
+  if (key.empty()) {
+    return;
+  }
+  std::string base = this->dir + "/" + key;
+  std::string tmp_obj = generateRandomFilePath(this->dir, ".o.tmp");
+  std::string tmp_man = generateRandomFilePath(this->dir, ".manifest.tmp");
+  std::error_code ec;
+  if (!std::filesystem::copy_file(object, tmp_obj, std::filesystem::copy_options::overwrite_existing, ec)) {
+    return;
+  }
+  std::ofstream manifest(tmp_man);
+  manifest << CACHE_MANIFEST_MAGIC << "\n";
+  for (const std::string &dep : deps) {
+    std::string hash = hashFile(dep);
+    if (hash.empty()) {
+      manifest.close();
+      std::filesystem::remove(tmp_obj, ec);
+      std::filesystem::remove(tmp_man, ec);
+      return;
+    }
+    manifest << "dep " << hash << " " << dep << "\n";
+  }
+  for (const std::string &flag : ld_flags) {
+    manifest << "ldflag " << flag << "\n";
+  }
+  for (const std::string &imp : imports) {
+    manifest << "import " << imp << "\n";
+  }
+  manifest.close();
+  std::filesystem::rename(tmp_obj, base + ".o", ec);
+  std::filesystem::rename(tmp_man, base + ".manifest", ec);
+}
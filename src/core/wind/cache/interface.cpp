@@ -0,0 +1,454 @@
+/**
+ * @file interface.cpp
+ * @brief Precompiled interface images (.wic).
+ */
+
+#include <wind/cache/interface.h>
+#include <wind/bridge/arena.h>
+#include <wind/processing/utils.h>
+
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+
+#define INTERFACE_IMAGE_MAGIC "WIC1"
+
+enum ImageNode : uint8_t {
+  IMAGE_NONE,
+  IMAGE_FUNCTION,
+  IMAGE_ARG,
+  IMAGE_TYPE_DECL,
+  IMAGE_GLOBAL,
+  IMAGE_LITERAL,
+  IMAGE_STRING,
+  IMAGE_VARIABLE,
+  IMAGE_BINARY,
+  IMAGE_CAST,
+  IMAGE_SIZEOF
+};
+
+// Encodes the declarations of an interface, anything else marks the
+// interface as not encodable
+class ImageWriter : public ASTVisitor {
+public:
+  std::string out;
+  bool ok = true;
+
+  void u8(uint8_t v) { this->out.push_back((char)v); }
+  void u32(uint32_t v) { this->out.append((const char*)&v, sizeof(v)); }
+  void i64(int64_t v) { this->out.append((const char*)&v, sizeof(v)); }
+  void str(const std::string &s) { this->u32(s.size()); this->out += s; }
+  void type(const TypeExpr *t);
+  void node(const ASTNode *n);
+
+  void *visit(const BinaryExpr &node) override;
+  void *visit(const VariableRef &node) override;
+  void *visit(const VarAddressing &) override { return this->fail(); }
+  void *visit(const Literal &node) override;
+  void *visit(const Return &) override { return this->fail(); }
+  void *visit(const Body &) override { return this->fail(); }
+  void *visit(const Function &node) override;
+  void *visit(const ArgDecl &node) override;
+  void *visit(const VariableDecl &) override { return this->fail(); }
+  void *visit(const GlobalDecl &node) override;
+  void *visit(const FnCall &) override { return this->fail(); }
+  void *visit(const InlineAsm &) override { return this->fail(); }
+  void *visit(const StringLiteral &node) override;
+  void *visit(const TypeDecl &node) override;
+  void *visit(const Branching &) override { return this->fail(); }
+  void *visit(const Looping &) override { return this->fail(); }
+  void *visit(const Break &) override { return this->fail(); }
+  void *visit(const Continue &) override { return this->fail(); }
+  void *visit(const GenericIndexing &) override { return this->fail(); }
+  void *visit(const PtrGuard &) override { return this->fail(); }
+  void *visit(const TypeCast &node) override;
+  void *visit(const SizeOf &node) override;
+  void *visit(const TryCatch &) override { return this->fail(); }
+
+private:
+  void *fail() { this->ok = false; return nullptr; }
+};
+
+void ImageWriter::type(const TypeExpr *t) {
+  this->u8(t->kind);
+  switch (t->kind) {
+    case TypeExpr::NAMED:
+      this->str(t->spelling);
+      break;
+    case TypeExpr::POINTER:
+      this->type(t->inner);
+      break;
+    case TypeExpr::ARRAY:
+      this->type(t->inner);
+      this->u32(t->capacity);
+      break;
+  }
+}
+
+void ImageWriter::node(const ASTNode *n) {
+  if (n == nullptr) {
+    this->u8(IMAGE_NONE);
+    return;
+  }
+  n->accept(*this);
+}
+
+void *ImageWriter::visit(const Function &node) {
+  if (node.isDefined) {
+    return this->fail();
+  }
+  this->u8(IMAGE_FUNCTION);
+  this->str(node.getName());
+  this->type(node.getType());
+  this->u32(node.flags);
+  this->str(node.metadata);
+  const std::vector<ASTPtr<ASTNode>> &args = node.getBody()->get();
+  this->u32(args.size());
+  for (const auto &arg : args) {
+    this->node(arg.get());
+  }
+  const std::vector<const TypeExpr*> &types = node.getArgTypes();
+  this->u32(types.size());
+  for (const TypeExpr *t : types) {
+    this->type(t);
+  }
+  return nullptr;
+}
+
+void *ImageWriter::visit(const ArgDecl &node) {
+  this->u8(IMAGE_ARG);
+  this->str(node.getName());
+  this->type(node.getType());
+  return nullptr;
+}
+
+void *ImageWriter::visit(const TypeDecl &node) {
+  this->u8(IMAGE_TYPE_DECL);
+  this->str(node.getName());
+  this->type(node.getType());
+  return nullptr;
+}
+
+void *ImageWriter::visit(const GlobalDecl &node) {
+  this->u8(IMAGE_GLOBAL);
+  this->str(node.getName());
+  this->type(node.getType());
+  this->node(node.getValue());
+  return nullptr;
+}
+
+void *ImageWriter::visit(const Literal &node) {
+  this->u8(IMAGE_LITERAL);
+  this->i64(node.get());
+  return nullptr;
+}
+
+void *ImageWriter::visit(const StringLiteral &node) {
+  this->u8(IMAGE_STRING);
+  this->str(node.getValue());
+  return nullptr;
+}
+
+void *ImageWriter::visit(const VariableRef &node) {
+  this->u8(IMAGE_VARIABLE);
+  this->str(node.getName());
+  return nullptr;
+}
+
+void *ImageWriter::visit(const BinaryExpr &node) {
+  this->u8(IMAGE_BINARY);
+  this->str(node.getOperator());
+  this->node(node.getLeft());
+  this->node(node.getRight());
+  return nullptr;
+}
+
+void *ImageWriter::visit(const TypeCast &node) {
+  this->u8(IMAGE_CAST);
+  this->type(node.getType());
+  this->node(node.getValue());
+  return nullptr;
+}
+
+void *ImageWriter::visit(const SizeOf &node) {
+  this->u8(IMAGE_SIZEOF);
+  this->type(node.getType());
+  return nullptr;
+}
+
+/**
+ * @brief Writes an interface image.
+ * @param file The image file.
+ * @param iface The interface, whose nested interfaces are referenced by path.
+ * @return False if the interface can't be encoded or written.
+ *
+ * The image is written under a temporary name and renamed, so concurrent
+ * windc processes never read a half written image.
+ */
+bool WriteInterfaceImage(const std::string &file, const InterfaceDesc *iface) {
+  ImageWriter w;
+  w.out += INTERFACE_IMAGE_MAGIC;
+  w.i64(iface->mtime);
+  w.u32(iface->nested.size());
+  for (const NestedInterface &nested : iface->nested) {
+    w.str(nested.iface->path);
+    w.i64(nested.iface->mtime);
+    w.u32(nested.at);
+    w.u8(nested.once);
+  }
+  w.u32(iface->imports.size());
+  for (const std::string &imp : iface->imports) {
+    w.str(imp);
+  }
+  w.u32(iface->ld_flags.size());
+  for (const std::string &flag : iface->ld_flags) {
+    w.str(flag);
+  }
+  const std::vector<ASTPtr<ASTNode>> &statements = iface->ast->get();
+  w.u32(statements.size());
+  for (const auto &statement : statements) {
+    w.node(statement.get());
+  }
+  w.u32(iface->ast->consts_table.size());
+  for (auto &const_pair : iface->ast->consts_table) {
+    w.str(const_pair.first);
+    w.node(const_pair.second);
+  }
+  if (!w.ok) {
+    return false;
+  }
+
+  std::string dir = std::filesystem::path(file).parent_path().string();
+  std::string tmp = generateRandomFilePath(dir, ".wic.tmp");
+  std::ofstream out(tmp, std::ios::binary);
+  out.write(w.out.data(), w.out.size());
+  out.close();
+  std::error_code ec;
+  if (!out) {
+    std::filesystem::remove(tmp, ec);
+    return false;
+  }
+  std::filesystem::rename(tmp, file, ec);
+  return !ec;
+}
+
+// Decodes a mapped image, any read past the end fails the whole image
+class ImageReader {
+public:
+  ImageReader(const char *data, size_t size) : cur(data), end(data + size) {}
+  bool ok = true;
+
+  const char *take(size_t n);
+  uint8_t u8() { const char *p = this->take(1); return p ? (uint8_t)*p : 0; }
+  uint32_t u32() { uint32_t v = 0; if (const char *p = this->take(sizeof(v))) memcpy(&v, p, sizeof(v)); return v; }
+  int64_t i64() { int64_t v = 0; if (const char *p = this->take(sizeof(v))) memcpy(&v, p, sizeof(v)); return v; }
+  std::string str();
+  const TypeExpr *type(unsigned depth = 0);
+  ASTNode *node();
+  bool done() const { return this->ok && this->cur == this->end; }
+
+private:
+  const char *cur;
+  const char *end;
+};
+
+const char *ImageReader::take(size_t n) {
+  if (!this->ok || (size_t)(this->end - this->cur) < n) {
+    this->ok = false;
+    return nullptr;
+  }
+  const char *p = this->cur;
+  this->cur += n;
+  return p;
+}
+
+std::string ImageReader::str() {
+  uint32_t size = this->u32();
+  const char *p = this->take(size);
+  return p ? std::string(p, size) : "";
+}
+
+const TypeExpr *ImageReader::type(unsigned depth) {
+  uint8_t kind = this->u8();
+  if (!this->ok || depth > 64) {
+    this->ok = false;
+    return nullptr;
+  }
+  switch (kind) {
+    case TypeExpr::NAMED:
+      return TypeTable::Named(this->str());
+    case TypeExpr::POINTER: {
+      const TypeExpr *inner = this->type(depth + 1);
+      return inner ? TypeTable::Pointer(inner) : nullptr;
+    }
+    case TypeExpr::ARRAY: {
+      const TypeExpr *inner = this->type(depth + 1);
+      uint32_t capacity = this->u32();
+      return inner ? TypeTable::Array(inner, capacity) : nullptr;
+    }
+  }
+  this->ok = false;
+  return nullptr;
+}
+
+ASTNode *ImageReader::node() {
+  uint8_t tag = this->u8();
+  if (!this->ok) {
+    return nullptr;
+  }
+  switch (tag) {
+    case IMAGE_NONE:
+      return nullptr;
+    case IMAGE_FUNCTION: {
+      std::string name = this->str();
+      const TypeExpr *ret_type = this->type();
+      FnFlags flags = this->u32();
+      std::string metadata = this->str();
+      Body *fn_body = new Body({});
+      uint32_t args = this->u32();
+      for (uint32_t i = 0; i < args && this->ok; i++) {
+        *fn_body += ASTPtr<ASTNode>(this->node());
+      }
+      std::vector<const TypeExpr*> arg_types;
+      uint32_t types = this->u32();
+      for (uint32_t i = 0; i < types && this->ok; i++) {
+        arg_types.push_back(this->type());
+      }
+      Function *fn = new Function(name, ret_type, ASTPtr<Body>(fn_body));
+      fn->isDefined = false;
+      fn->metadata = metadata;
+      fn->copyArgTypes(arg_types);
+      fn->flags = flags;
+      return fn;
+    }
+    case IMAGE_ARG: {
+      std::string name = this->str();
+      return new ArgDecl(name, this->type());
+    }
+    case IMAGE_TYPE_DECL: {
+      std::string name = this->str();
+      return new TypeDecl(name, this->type());
+    }
+    case IMAGE_GLOBAL: {
+      std::string name = this->str();
+      const TypeExpr *type = this->type();
+      return new GlobalDecl(name, type, ASTPtr<ASTNode>(this->node()));
+    }
+    case IMAGE_LITERAL:
+      return new Literal(this->i64());
+    case IMAGE_STRING:
+      return new StringLiteral(this->str());
+    case IMAGE_VARIABLE:
+      return new VariableRef(this->str());
+    case IMAGE_BINARY: {
+      std::string op = this->str();
+      ASTNode *left = this->node();
+      ASTNode *right = this->node();
+      return new BinaryExpr(ASTPtr<ASTNode>(left), ASTPtr<ASTNode>(right), op);
+    }
+    case IMAGE_CAST: {
+      const TypeExpr *type = this->type();
+      return new TypeCast(type, ASTPtr<ASTNode>(this->node()));
+    }
+    case IMAGE_SIZEOF:
+      return new SizeOf(this->type());
+  }
+  this->ok = false;
+  return nullptr;
+}
+
+/**
+ * @brief Reads the interface an image was written for.
+ * @param file The image file.
+ * @param iface The interface to fill, with its path and current mtime.
+ * @param resolve Resolves the nested interfaces of the image.
+ * @return False if the image is missing, corrupt, or was written for another
+ * version of the source or of a nested interface. The interface is left
+ * empty then.
+ */
+bool ReadInterfaceImage(const std::string &file, InterfaceDesc *iface, const NestedResolver &resolve) {
+  int fd = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < (off_t)strlen(INTERFACE_IMAGE_MAGIC)) {
+    close(fd);
+    return false;
+  }
+  size_t size = st.st_size;
+  void *addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    return false;
+  }
+  ImageReader r((const char*)addr, size);
+  const char *magic = r.take(strlen(INTERFACE_IMAGE_MAGIC));
+  if (memcmp(magic, INTERFACE_IMAGE_MAGIC, strlen(INTERFACE_IMAGE_MAGIC)) != 0) {
+    munmap(addr, size);
+    return false;
+  }
+
+  if (r.i64() != iface->mtime) {
+    munmap(addr, size);
+    return false;
+  }
+  uint32_t nested_count = r.u32();
+  for (uint32_t i = 0; i < nested_count && r.ok; i++) {
+    std::string path = r.str();
+    int64_t mtime = r.i64();
+    size_t at = r.u32();
+    bool once = r.u8();
+    InterfaceDesc *nested = r.ok ? resolve(path, mtime) : nullptr;
+    if (nested == nullptr) {
+      r.ok = false;
+      break;
+    }
+    iface->nested.push_back({at, nested, once});
+  }
+  uint32_t imports = r.u32();
+  for (uint32_t i = 0; i < imports && r.ok; i++) {
+    iface->imports.push_back(r.str());
+  }
+  uint32_t ld_flags = r.u32();
+  for (uint32_t i = 0; i < ld_flags && r.ok; i++) {
+    iface->ld_flags.push_back(r.str());
+  }
+
+  iface->arena = new ASTArena();
+  Body *ast;
+  {
+    ASTArena::Scope scope(iface->arena);
+    ast = new Body({});
+    uint32_t statements = r.u32();
+    for (uint32_t i = 0; i < statements && r.ok; i++) {
+      *ast += ASTPtr<ASTNode>(r.node());
+    }
+    uint32_t consts = r.u32();
+    for (uint32_t i = 0; i < consts && r.ok; i++) {
+      std::string name = r.str();
+      ast->consts_table[name] = r.node();
+    }
+  }
+  munmap(addr, size);
+  for (const NestedInterface &nested : iface->nested) {
+    if (nested.at > ast->get().size()) {
+      r.ok = false;
+    }
+  }
+  if (!r.done()) {
+    delete iface->arena;
+    iface->arena = nullptr;
+    iface->nested.clear();
+    iface->imports.clear();
+    iface->ld_flags.clear();
+    return false;
+  }
+  iface->ast = ast;
+  return true;
+}
@@ -0,0 +1,215 @@
+/**
+ * @file memory.cpp
+ * @brief Allocation counting per phase and peak RSS reporting (-fmem-report).
+ *
+ * The global operator new/delete are replaced here; when the report is off
+ * they only add a relaxed load in front of malloc/free.
+ */
+
+#include <wind/common/memory.h>
+
+#include <sys/resource.h>
+#include <malloc.h>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <new>
+#include <string>
+
+#define MEMORY_MAX_PHASES 64
+
+struct MemoryCounters {
+  std::atomic<uint64_t> count{0};
+  std::atomic<uint64_t> bytes{0};
+  std::atomic<long> peak_rss{0}; // KiB, highest seen when a span of the phase ended
+};
+
+static std::atomic<bool> enabled(false);
+static MemoryCounters counters[MEMORY_MAX_PHASES];
+static const char *phase_names[MEMORY_MAX_PHASES] = {"driver"};
+static std::atomic<int> phase_count(1);
+static std::mutex phases_mutex;
+static std::atomic<uint64_t> freed_count(0);
+static std::atomic<uint64_t> freed_bytes(0);
+
+// Phase charged for allocations of this thread, 0 outside any span
+static thread_local int current_phase = 0;
+
+void EnableMemoryReport() {
+  enabled = true;
+}
+
+bool MemoryReportEnabled() {
+  return enabled.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Gets the id of a phase, registering it on first use.
+ * @param phase The phase name (a literal).
+ */
+int MemoryPhaseId(const char *phase) {
+  int count = phase_count.load(std::memory_order_acquire);
+  for (int i = 0; i < count; i++) {
+    if (strcmp(phase_names[i], phase) == 0) {
+      return i;
+    }
+  }
+  std::lock_guard<std::mutex> lock(phases_mutex);
+  count = phase_count.load();
+  for (int i = 0; i < count; i++) {
+    if (strcmp(phase_names[i], phase) == 0) {
+      return i;
+    }
+  }
+  if (count == MEMORY_MAX_PHASES) {
+    return 0;
+  }
+  phase_names[count] = phase;
+  phase_count.store(count + 1, std::memory_order_release);
+  return count;
+}
+
+/**
+ * @brief Charges the following allocations of this thread to a phase.
+ * @return The previous phase, to be given back to LeaveMemoryPhase.
+ */
+int EnterMemoryPhase(int id) {
+  int previous = current_phase;
+  current_phase = id;
+  return previous;
+}
+
+/**
+ * @brief Ends a span of a phase and samples the peak RSS.
+ */
+void LeaveMemoryPhase(int id, int previous) {
+  current_phase = previous;
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  long seen = counters[id].peak_rss.load(std::memory_order_relaxed);
+  while (usage.ru_maxrss > seen &&
+         !counters[id].peak_rss.compare_exchange_weak(seen, usage.ru_maxrss)) {}
+}
+
+/**
+ * @brief Gets the allocations charged to a phase so far.
+ */
+void MemoryPhaseUsage(int id, uint64_t &count, uint64_t &bytes) {
+  count = counters[id].count.load();
+  bytes = counters[id].bytes.load();
+}
+
+/**
+ * @brief Counts an allocation against the current phase.
+ */
+static inline void countAllocation(size_t size) {
+  if (enabled.load(std::memory_order_relaxed)) {
+    counters[current_phase].count.fetch_add(1, std::memory_order_relaxed);
+    counters[current_phase].bytes.fetch_add(size, std::memory_order_relaxed);
+  }
+}
+
+/**
+ * @brief Counts a release, sized by the allocator since most deletes aren't.
+ */
+static inline void countRelease(void *ptr) {
+  if (ptr && enabled.load(std::memory_order_relaxed)) {
+    freed_count.fetch_add(1, std::memory_order_relaxed);
+    freed_bytes.fetch_add(malloc_usable_size(ptr), std::memory_order_relaxed);
+  }
+}
+
+void *operator new(size_t size) {
+  countAllocation(size);
+  void *ptr = malloc(size ? size : 1);
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void *operator new[](size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept {
+  countRelease(ptr);
+  free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+  operator delete(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+  operator delete(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept {
+  operator delete(ptr);
+}
+
+/**
+ * @brief Gets the subsystem a phase belongs to.
+ */
+static const char *subsystemOf(const std::string &phase) {
+  if (phase == "lex") return "lexer";
+  if (phase == "parse" || phase == "include" || phase == "import") return "parser";
+  if (phase == "compile" || phase == "optimize") return "ir";
+  if (phase == "emit" || phase == "assemble" || phase == "jit") return "backend";
+  return "driver";
+}
+
+/**
+ * @brief Prints allocations per phase and per subsystem, then peak RSS.
+ *
+ * Bytes are the requested sizes; nothing the frontend allocates is freed
+ * before exit, so allocated bytes track the heap growth of each phase.
+ */
+void PrintMemoryReport(std::ostream &out) {
+  char line[256];
+  int count = phase_count.load();
+  std::map<std::string, std::pair<uint64_t, uint64_t>> subsystems;
+  uint64_t total_count = 0, total_bytes = 0;
+  out << "===-- windc memory report --===\n";
+  out << "       allocs     alloc(MiB)  peak-rss(MiB)  phase\n";
+  for (int i = 0; i < count; i++) {
+    uint64_t n = counters[i].count.load();
+    uint64_t bytes = counters[i].bytes.load();
+    if (!n) continue;
+    char rss[32] = "-";
+    if (counters[i].peak_rss.load()) {
+      snprintf(rss, sizeof(rss), "%.3f", counters[i].peak_rss.load() / 1024.0);
+    }
+    snprintf(line, sizeof(line), "%13llu %14.3f %14s  %s\n",
+      (unsigned long long)n, bytes / 1048576.0, rss, phase_names[i]);
+    out << line;
+    subsystems[subsystemOf(phase_names[i])].first += n;
+    subsystems[subsystemOf(phase_names[i])].second += bytes;
+    total_count += n;
+    total_bytes += bytes;
+  }
+  snprintf(line, sizeof(line), "%13llu %14.3f %14s  total\n",
+    (unsigned long long)total_count, total_bytes / 1048576.0, "");
+  out << line;
+
+  out << "\nPer subsystem:\n";
+  for (auto &sub : subsystems) {
+    snprintf(line, sizeof(line), "%13llu %14.3f  %s\n",
+      (unsigned long long)sub.second.first, sub.second.second / 1048576.0, sub.first.c_str());
+    out << line;
+  }
+
+  struct rusage self, children;
+  getrusage(RUSAGE_SELF, &self);
+  getrusage(RUSAGE_CHILDREN, &children);
+  snprintf(line, sizeof(line), "\nFreed: %llu allocations, %.3f MiB\n",
+    (unsigned long long)freed_count.load(), freed_bytes.load() / 1048576.0);
+  out << line;
+  snprintf(line, sizeof(line), "Peak RSS: %.3f MiB (largest child process: %.3f MiB)\n",
+    self.ru_maxrss / 1024.0, children.ru_maxrss / 1024.0);
+  out << line;
+}
@@ -0,0 +1,203 @@
+/**
+ * @file timing.cpp
+ * @brief Per-phase timing (-ftime-report) and trace export (--trace-json).
+ */
+
+#include <wind/common/timing.h>
+#include <wind/common/memory.h>
+
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <vector>
+
+struct TimeEvent {
+  const char *phase;
+  std::string file;
+  uint64_t start;     // ns since the trace was enabled
+  uint64_t wall;
+  uint64_t cpu;
+  uint64_t self_wall;
+  uint64_t self_cpu;
+  uint32_t tid;
+};
+
+static std::atomic<bool> enabled(false);
+static uint64_t epoch = 0;
+static std::mutex events_mutex;
+static std::vector<TimeEvent> events;
+static std::atomic<uint32_t> next_tid(1);
+
+thread_local WindTimer *current_timer = nullptr;
+thread_local uint32_t thread_tid = 0;
+
+/**
+ * @brief Reads a clock in nanoseconds.
+ */
+static uint64_t clockNs(clockid_t clock) {
+  struct timespec ts;
+  clock_gettime(clock, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+void EnableTimeTrace() {
+  epoch = clockNs(CLOCK_MONOTONIC);
+  enabled = true;
+}
+
+bool TimeTraceEnabled() {
+  return enabled;
+}
+
+/**
+ * @brief Opens a span.
+ * @param phase The phase name, must outlive the trace (a literal).
+ * @param file The file the phase works on, if any.
+ */
+WindTimer::WindTimer(const char *phase, std::string file) :
+  active(enabled || MemoryReportEnabled()), timed(enabled), phase(phase) {
+  if (!this->active) {
+    return;
+  }
+  if (MemoryReportEnabled()) {
+    this->mem_phase = MemoryPhaseId(phase);
+    this->mem_previous = EnterMemoryPhase(this->mem_phase);
+  }
+  this->parent = current_timer;
+  // Phases without a file of their own (as) belong to the enclosing one
+  this->file = file.empty() && this->parent ? this->parent->file : file;
+  current_timer = this;
+  this->start_wall = clockNs(CLOCK_MONOTONIC);
+  this->start_cpu = clockNs(CLOCK_THREAD_CPUTIME_ID);
+}
+
+/**
+ * @brief Closes the span and records it.
+ */
+WindTimer::~WindTimer() {
+  if (!this->active) {
+    return;
+  }
+  if (MemoryReportEnabled()) {
+    LeaveMemoryPhase(this->mem_phase, this->mem_previous);
+  }
+  uint64_t wall = clockNs(CLOCK_MONOTONIC) - this->start_wall;
+  uint64_t cpu = clockNs(CLOCK_THREAD_CPUTIME_ID) - this->start_cpu;
+  current_timer = this->parent;
+  if (this->parent) {
+    this->parent->child_wall += wall;
+    this->parent->child_cpu += cpu;
+  }
+  if (!this->timed) {
+    return;
+  }
+  if (!thread_tid) {
+    thread_tid = next_tid++;
+  }
+  TimeEvent event = {
+    this->phase, this->file, this->start_wall - epoch, wall, cpu,
+    wall - std::min(wall, this->child_wall), cpu - std::min(cpu, this->child_cpu), thread_tid
+  };
+  std::lock_guard<std::mutex> lock(events_mutex);
+  events.push_back(event);
+}
+
+/**
+ * @brief Prints one table of phases.
+ */
+static void printTable(std::ostream &out, std::map<std::string, std::pair<uint64_t, uint64_t>> &phases) {
+  std::vector<std::pair<std::string, std::pair<uint64_t, uint64_t>>> rows(phases.begin(), phases.end());
+  std::sort(rows.begin(), rows.end(), [](auto &a, auto &b) { return a.second.first > b.second.first; });
+  uint64_t total_wall = 0, total_cpu = 0;
+  char line[256];
+  for (auto &row : rows) {
+    snprintf(line, sizeof(line), "%12.3f %12.3f  %s\n",
+      row.second.first / 1e6, row.second.second / 1e6, row.first.c_str());
+    out << line;
+    total_wall += row.second.first;
+    total_cpu += row.second.second;
+  }
+  snprintf(line, sizeof(line), "%12.3f %12.3f  total\n", total_wall / 1e6, total_cpu / 1e6);
+  out << line;
+}
+
+/**
+ * @brief Prints the self wall and CPU time of every phase, then per file.
+ *
+ * With -j the per-phase totals add up the threads, so they can exceed the
+ * wall time of the whole run. Child processes (as, ld) only show wall time.
+ */
+void PrintTimeReport(std::ostream &out) {
+  std::lock_guard<std::mutex> lock(events_mutex);
+  std::map<std::string, std::pair<uint64_t, uint64_t>> phases;
+  std::map<std::string, std::map<std::string, std::pair<uint64_t, uint64_t>>> files;
+  for (TimeEvent &event : events) {
+    phases[event.phase].first += event.self_wall;
+    phases[event.phase].second += event.self_cpu;
+    if (!event.file.empty()) {
+      files[event.file][event.phase].first += event.self_wall;
+      files[event.file][event.phase].second += event.self_cpu;
+    }
+  }
+  out << "===-- windc time report --===\n";
+  out << "     wall(ms)      cpu(ms)  phase\n";
+  printTable(out, phases);
+  for (auto &file : files) {
+    out << "\n" << file.first << ":\n";
+    printTable(out, file.second);
+  }
+}
+
+/**
+ * @brief Escapes a string for a JSON literal.
+ */
+static std::string jsonEscape(const std::string &str) {
+  std::string out;
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += c;
+    } else if ((unsigned char)c < 0x20) {
+      char buf[8];
+      snprintf(buf, sizeof(buf), "\\u%04x", c);
+      out += buf;
+    } else {
+      out += c;
+    }
+  }
+  return out;
+}
+
+/**
+ * @brief Writes the spans as Chrome trace events (chrome://tracing, Perfetto).
+ * @param path The output path.
+ * @return False if the file can't be written.
+ */
+bool WriteTimeTrace(std::string path) {
+  std::ofstream file(path);
+  if (!file.is_open()) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(events_mutex);
+  int pid = getpid();
+  file << "{\"traceEvents\":[";
+  char buf[256];
+  for (size_t i = 0; i < events.size(); i++) {
+    TimeEvent &event = events[i];
+    snprintf(buf, sizeof(buf),
+      "%s\n{\"name\":\"%s\",\"cat\":\"windc\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%u,\"args\":{\"cpu_us\":%.3f",
+      i ? "," : "", event.phase, event.start / 1e3, event.wall / 1e3, pid, event.tid, event.cpu / 1e3);
+    file << buf;
+    if (!event.file.empty()) {
+      file << ",\"file\":\"" << jsonEscape(event.file) << "\"";
+    }
+    file << "}}";
+  }
+  file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+  return file.good();
+}
@@ -523,7 +523,7 @@ const std::string &IRInlineAsm::code() const {
  * @brief Constructor for IRBranching.
  * @param branches The branches.
  */
-IRBranching::IRBranching(std::vector<IRBranch> &branches): branches(std::move(branches)) {}
+IRBranching::IRBranching(std::vector<IRBranch> &branches): branches(std::move(branches)), else_branch(nullptr) {}
 
 /**
  * @brief Gets the branches.
@@ -122,10 +122,10 @@ void* WindCompiler::visit(const BinaryExpr &node) {
       // discontinued as unsafe (unchecked overflow)
       // op = IRBinOp::Operation::L_PLUS_ASSIGN;
       return (IRNode*)(new BinaryExpr(
-        std::unique_ptr<ASTNode>((ASTNode*)node.getLeft()),
-        std::unique_ptr<ASTNode>(new BinaryExpr(
-          std::unique_ptr<ASTNode>((ASTNode*)node.getLeft()),
-          std::unique_ptr<ASTNode>((ASTNode*)node.getRight()),
+        ASTPtr<ASTNode>((ASTNode*)node.getLeft()),
+        ASTPtr<ASTNode>(new BinaryExpr(
+          ASTPtr<ASTNode>((ASTNode*)node.getLeft()),
+          ASTPtr<ASTNode>((ASTNode*)node.getRight()),
           "+"
         )),
         "="
@@ -134,10 +134,10 @@ void* WindCompiler::visit(const BinaryExpr &node) {
     else if (left->type() == IRNode::NodeType::GLOBAL_REF) {
       //op = IRBinOp::Operation::G_PLUS_ASSIGN;
       return (IRNode*)(new BinaryExpr(
-        std::unique_ptr<ASTNode>((ASTNode*)node.getLeft()),
-        std::unique_ptr<ASTNode>(new BinaryExpr(
-          std::unique_ptr<ASTNode>((ASTNode*)node.getLeft()),
-          std::unique_ptr<ASTNode>((ASTNode*)node.getRight()),
+        ASTPtr<ASTNode>((ASTNode*)node.getLeft()),
+        ASTPtr<ASTNode>(new BinaryExpr(
+          ASTPtr<ASTNode>((ASTNode*)node.getLeft()),
+          ASTPtr<ASTNode>((ASTNode*)node.getRight()),
           "+"
         )),
         "="
@@ -152,10 +152,10 @@ void* WindCompiler::visit(const BinaryExpr &node) {
       // discontinued as unsafe (unchecked overflow)
       //op = IRBinOp::Operation::L_MINUS_ASSIGN;
       return (IRNode*)(new BinaryExpr(
-        std::unique_ptr<ASTNode>((ASTNode*)node.getLeft()),
-        std::unique_ptr<ASTNode>(new BinaryExpr(
-          std::unique_ptr<ASTNode>((ASTNode*)node.getLeft()),
-          std::unique_ptr<ASTNode>((ASTNode*)node.getRight()),
+        ASTPtr<ASTNode>((ASTNode*)node.getLeft()),
+        ASTPtr<ASTNode>(new BinaryExpr(
+          ASTPtr<ASTNode>((ASTNode*)node.getLeft()),
+          ASTPtr<ASTNode>((ASTNode*)node.getRight()),
           "-"
         )),
         "="
@@ -164,10 +164,10 @@ void* WindCompiler::visit(const BinaryExpr &node) {
     else if (left->type() == IRNode::NodeType::GLOBAL_REF) {
       //op = IRBinOp::Operation::G_MINUS_ASSIGN;
       return (IRNode*)(new BinaryExpr(
-        std::unique_ptr<ASTNode>((ASTNode*)node.getLeft()),
-        std::unique_ptr<ASTNode>(new BinaryExpr(
-          std::unique_ptr<ASTNode>((ASTNode*)node.getLeft()),
-          std::unique_ptr<ASTNode>((ASTNode*)node.getRight()),
+        ASTPtr<ASTNode>((ASTNode*)node.getLeft()),
+        ASTPtr<ASTNode>(new BinaryExpr(
+          ASTPtr<ASTNode>((ASTNode*)node.getLeft()),
+          ASTPtr<ASTNode>((ASTNode*)node.getRight()),
           "-"
         )),
         "="
@@ -330,7 +330,7 @@ void* WindCompiler::visit(const Function &node) {
   this->current_fn = fn;
   fn->return_type = this->ResolveDataType(node.getType());
   std::vector<DataType*> arg_types;
-  for (std::string type : node.getArgTypes()) {
+  for (const TypeExpr *type : node.getArgTypes()) {
     arg_types.push_back(this->ResolveDataType(type));
   }
   fn->copyArgTypes(arg_types);
@@ -343,60 +343,55 @@ void* WindCompiler::visit(const Function &node) {
 }
 
 /**
- * @brief Resolves a data type from its string representation.
- * @param type The string representation of the data type.
- * @return The resolved data type.
+ * @brief Resolves a data type from its type expression.
+ * @param type The interned type expression.
+ * @return The resolved data type, shared by every mention of the type.
  */
-DataType *WindCompiler::ResolveDataType(const std::string &n_type) {
-  if (n_type[0]=='[' && n_type[n_type.size()-1]==']') {
-    uint32_t capacity = 0, size=0;
-    std::string inner = n_type.substr(1, n_type.size()-2);
-    // if semicolon is present, there's capacity
-    if (inner.find(';') != std::string::npos) {
-      std::string cap = inner.substr(inner.find(';')+1);
-      inner = inner.substr(0, inner.find(';'));
-      capacity = fmtinttostr(cap);
-    }
-    DataType *intype = this->ResolveDataType(inner);
-    size = intype->moveSize();
-    if (capacity != 0) {
-      return new DataType(size, capacity, intype);
+DataType *WindCompiler::ResolveDataType(const TypeExpr *type) {
+  auto found = this->resolved_types.find(type);
+  if (found != this->resolved_types.end()) {
+    return found->second;
+  }
+  DataType *resolved = nullptr;
+  if (type->kind == TypeExpr::ARRAY) {
+    DataType *intype = this->ResolveDataType(type->inner);
+    uint32_t size = intype->moveSize();
+    if (type->capacity != 0) {
+      resolved = new DataType(size, type->capacity, intype);
+    } else {
+      resolved = new DataType(size, intype);
     }
-    return new DataType(size, intype);
   }
-  else if (n_type.substr(0, 4) == "ptr<") {
-    std::string inner = n_type.substr(4, n_type.size()-5);
-    DataType *intype = this->ResolveDataType(inner);
-    return new DataType(intype);
+  else if (type->kind == TypeExpr::POINTER) {
+    resolved = new DataType(this->ResolveDataType(type->inner));
   }
-  bool unsigned_type = n_type.find("unsigned") != std::string::npos;
-  size_t sf = n_type.find(" ");
-  std::string type = n_type.substr((sf!=std::string::npos) ? sf+1 : 0);
-  type.erase(std::remove(type.begin(), type.end(), ' '), type.end());
-  if (type == "byte") {
-    return new DataType(DataType::Sizes::BYTE, !unsigned_type);
+  else if (type->name == "byte") {
+    resolved = new DataType(DataType::Sizes::BYTE, !type->is_unsigned);
   }
-  else if (type == "short") {
-    return new DataType(DataType::Sizes::WORD, !unsigned_type);
+  else if (type->name == "short") {
+    resolved = new DataType(DataType::Sizes::WORD, !type->is_unsigned);
   }
-  else if (type == "int") {
-    return new DataType(DataType::Sizes::DWORD, !unsigned_type);
+  else if (type->name == "int") {
+    resolved = new DataType(DataType::Sizes::DWORD, !type->is_unsigned);
   }
-  else if (type == "long") {
-    return new DataType(DataType::Sizes::QWORD, !unsigned_type);
+  else if (type->name == "long") {
+    resolved = new DataType(DataType::Sizes::QWORD, !type->is_unsigned);
   }
-  else if (type == "void") {
-    return new DataType(DataType::Sizes::VOID, false);
+  else if (type->name == "void") {
+    resolved = new DataType(DataType::Sizes::VOID, false);
   }
-  else if (this->userdef_types_map.find(type) != this->userdef_types_map.end()) {
-    return this->userdef_types_map[type];
+  else if (this->userdef_types_map.find(type->name) != this->userdef_types_map.end()) {
+    resolved = this->userdef_types_map[type->name];
   }
-
-  std::string fn_name;
-  if (this->current_fn) {
-    fn_name = " in function: " + this->current_fn->name();
+  else {
+    std::string fn_name;
+    if (this->current_fn) {
+      fn_name = " in function: " + this->current_fn->name();
+    }
+    throw std::runtime_error("Invalid type " + type->name + fn_name);
   }
-  throw std::runtime_error("Invalid type " +type + fn_name);
+  this->resolved_types[type] = resolved;
+  return resolved;
 }
 
 /**
@@ -528,6 +523,8 @@ void *WindCompiler::visit(const InlineAsm &node) {
 void *WindCompiler::visit(const TypeDecl &node) {
   DataType *type = this->ResolveDataType(node.getType());
   this->userdef_types_map[node.getName()] = type;
+  // Types resolved through the previous definition are stale
+  this->resolved_types.clear();
   return nullptr;
 }
 
@@ -0,0 +1,34 @@
+/**
+ * @file interner.cpp
+ * @brief Interning of token values.
+ */
+
+#include <wind/isc/interner.h>
+
+/**
+ * @brief Constructor for WindInterner, interns keywords and symbols first.
+ */
+WindInterner::WindInterner() {
+  for (const std::string &keyword : KeywordTable) {
+    this->intern(keyword);
+  }
+  for (const auto &symbol : SymbolTable) {
+    this->intern(symbol.first);
+  }
+}
+
+/**
+ * @brief Interns a value.
+ * @param text The value.
+ * @return The id of the value, the same for equal values.
+ */
+TokenSymbol WindInterner::intern(std::string_view text) {
+  auto found = this->index.find(text);
+  if (found != this->index.end()) {
+    return found->second;
+  }
+  TokenSymbol symbol = this->strings.size();
+  this->strings.emplace_back(text);
+  this->index.emplace(this->strings.back(), symbol);
+  return symbol;
+}
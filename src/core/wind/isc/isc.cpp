@@ -5,61 +5,265 @@
 #include <wind/isc/isc.h>
 #include <wind/processing/utils.h>
 #include <wind/bridge/ast_printer.h>
+#include <wind/bridge/arena.h>
+#include <wind/cache/cache.h>
+#include <wind/cache/interface.h>
 #include <map>
 #include <memory>
 #include <iostream>
 #include <filesystem>
+#include <mutex>
+#include <set>
+#include <sys/stat.h>
 
-WindISC *global_isc;
+// Interfaces by real path, filled while compiling by any thread
+static std::map<std::string, InterfaceDesc*> interfaces;
+static std::mutex interfaces_mutex;
+// Where interface images are read and written, if anywhere
+static WindObjectCache *image_cache = nullptr;
+// Interfaces this thread is loading, innermost last. Includes of one of
+// them (include cycles) resolve to it while it is still empty.
+static thread_local std::vector<InterfaceDesc*> loading;
+// Interfaces loaded under the outermost one of this thread. They are only
+// published once it is complete, as they may refer to it.
+static thread_local std::vector<InterfaceDesc*> loaded;
 
-WindISC::WindISC() {}
+/**
+ * @brief Gets the modification time of a file in nanoseconds, -1 if missing.
+ */
+static int64_t fileMtime(const std::string &path) {
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0) {
+    return -1;
+  }
+  return (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+}
+
+thread_local WindISC *global_isc;
+
+WindISC::WindISC() : pending(nullptr), pending_once(true), building(nullptr) {}
 
 void WindISC::setPath(uint16_t id, std::string path) {
   if (id >= this->sources.size()) {
-    this->sources.insert({id, {path, nullptr, nullptr}});
+    this->sources.insert({id, {path, nullptr, nullptr, nullptr}});
   } else {
+    auto old = this->src_ids.find(this->sources[id].path);
+    if (old != this->src_ids.end() && old->second == id) {
+      this->src_ids.erase(old);
+    }
     this->sources[id].path = path;
   }
+  this->src_ids.emplace(path, id);
+}
+
+void WindISC::setSource(uint16_t id, SourceBuffer *source) {
+  this->sources[id].source = source;
+}
+
+// Getters only look up: parser workers read the ISC concurrently and
+// std::map::operator[] may insert
+
+SourceBuffer *WindISC::getSource(uint16_t id) const {
+  auto it = this->sources.find(id);
+  return it == this->sources.end() ? nullptr : it->second.source;
 }
 
 void WindISC::setStream(uint16_t id, TokenStream *stream) {
   this->sources[id].stream = stream;
 }
 
-void WindISC::newParserReport(uint16_t id, std::string src) {
-  this->sources[id].parser_report = new ParserReport(src);
+void WindISC::newParserReport(uint16_t id, const SourceBuffer *source) {
+  this->sources[id].parser_report = new ParserReport(source);
 }
 
-int16_t WindISC::getSrcId(std::string path) {
-  path = getRealPath(path);
+int16_t WindISC::getSrcId(std::string path) const {
+  auto it = this->src_ids.find(getRealPath(path));
+  return it == this->src_ids.end() ? -1 : it->second;
+}
+
+TokenStream *WindISC::getStream(uint16_t id) const {
+  auto it = this->sources.find(id);
+  return it == this->sources.end() ? nullptr : it->second.stream;
+}
+
+ParserReport *WindISC::getParserReport(uint16_t id) const {
+  auto it = this->sources.find(id);
+  return it == this->sources.end() ? nullptr : it->second.parser_report;
+}
+
+std::string WindISC::getPath(uint16_t id) const {
+  auto it = this->sources.find(id);
+  return it == this->sources.end() ? "" : it->second.path;
+}
+
+std::vector<std::string> WindISC::getPaths() const {
+  std::vector<std::string> paths;
   for (const auto &src : this->sources) {
-    if (src.second.path == path) {
-      return src.first;
+    paths.push_back(src.second.path);
+  }
+  return paths;
+}
+
+/**
+ * @brief Finds an interface of this thread by path.
+ * @param list The interfaces to search.
+ * @param path The real path of the interface.
+ */
+static InterfaceDesc *findInterface(const std::vector<InterfaceDesc*> &list, const std::string &path) {
+  for (InterfaceDesc *iface : list) {
+    if (iface->path == path) {
+      return iface;
     }
   }
-  return -1;
+  return nullptr;
 }
 
-TokenStream *WindISC::getStream(uint16_t id) {
-  return this->sources[id].stream;
+/**
+ * @brief Checks that an interface and its nested ones are unchanged on disk.
+ * @param iface The interface.
+ * @param visited The interfaces already checked, include cycles end there.
+ *
+ * An interface that failed to load is stale, unless this thread is still
+ * loading it.
+ */
+static bool interfaceFresh(const InterfaceDesc *iface, std::set<const InterfaceDesc*> &visited) {
+  if (!visited.insert(iface).second) {
+    return true;
+  }
+  if (iface->ast == nullptr) {
+    return findInterface(loading, iface->path) == iface;
+  }
+  if (fileMtime(iface->path) != iface->mtime) {
+    return false;
+  }
+  for (const NestedInterface &nested : iface->nested) {
+    if (!interfaceFresh(nested.iface, visited)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Parses an interface for the cache.
+ * @param iface The interface, with its path and mtime.
+ * @return False if the file can't be read.
+ *
+ * The parse runs in a fresh ISC, so it doesn't depend on what the including
+ * unit already declared. Nested includes go through the cache as well and
+ * are only recorded, see commitAST.
+ */
+static bool parseInterface(InterfaceDesc *iface) {
+  iface->arena = new ASTArena();
+  WindISC *saved = global_isc;
+  global_isc = new WindISC();
+  global_isc->setBuilding(iface);
+  {
+    ASTArena::Scope scope(iface->arena);
+    WindLexer *lexer = StreamFile(iface->path.c_str());
+    if (lexer != nullptr) {
+      WindParser *parser = new WindParser(lexer->get(), iface->path);
+      iface->ast = parser->parse();
+      iface->imports = global_isc->takeImports();
+      iface->ld_flags = global_isc->getLdFlags();
+    }
+  }
+  delete global_isc;
+  global_isc = saved;
+  if (iface->ast == nullptr) {
+    delete iface->arena;
+    iface->arena = nullptr;
+    return false;
+  }
+  return true;
 }
 
-ParserReport *WindISC::getParserReport(uint16_t id) {
-  return this->sources[id].parser_report;
+static InterfaceDesc *loadInterface(std::string path);
+
+/**
+ * @brief Reads the precompiled image of an interface.
+ * @param iface The interface, with its path and mtime.
+ * @return False if there is no up to date image.
+ *
+ * Nested interfaces load like includes do, so cycles stored in images end
+ * at the interface being read.
+ */
+static bool readImage(InterfaceDesc *iface) {
+  if (image_cache == nullptr) {
+    return false;
+  }
+  return ReadInterfaceImage(
+    image_cache->interfaceImage(iface->path), iface,
+    [](const std::string &nested, int64_t mtime) -> InterfaceDesc* {
+      return fileMtime(nested) == mtime ? loadInterface(nested) : nullptr;
+    }
+  );
 }
 
-std::string WindISC::getPath(uint16_t id) {
-  return this->sources[id].path;
+/**
+ * @brief Gets an interface from the cache, parsing it if missing or stale.
+ * @param path The interface path.
+ * @return The interface, or nullptr if the file can't be read.
+ *
+ * An up to date image in the cache is read instead of parsing the source,
+ * and a freshly parsed interface is written back as an image.
+ * An interface this thread is already loading is returned as is, still
+ * empty: a cyclic include then acts as an include of a file already
+ * included. Two threads may parse the same interface at once, the last one
+ * is kept. Replaced interfaces are never freed, other units may still use
+ * them.
+ */
+static InterfaceDesc *loadInterface(std::string path) {
+  path = getRealPath(path);
+  if (InterfaceDesc *iface = findInterface(loading, path)) {
+    return iface;
+  }
+  if (InterfaceDesc *iface = findInterface(loaded, path)) {
+    std::set<const InterfaceDesc*> visited;
+    if (interfaceFresh(iface, visited)) {
+      return iface;
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lock(interfaces_mutex);
+    auto it = interfaces.find(path);
+    std::set<const InterfaceDesc*> visited;
+    if (it != interfaces.end() && interfaceFresh(it->second, visited)) {
+      return it->second;
+    }
+  }
+  // Never freed on failure either, cyclic includes may refer to it
+  InterfaceDesc *iface = new InterfaceDesc();
+  iface->path = path;
+  iface->mtime = fileMtime(path);
+  loading.push_back(iface);
+  bool from_image = readImage(iface);
+  bool ok = from_image || parseInterface(iface);
+  loading.pop_back();
+  if (!ok) {
+    return nullptr;
+  }
+  if (!from_image && image_cache != nullptr) {
+    WriteInterfaceImage(image_cache->interfaceImage(path), iface);
+  }
+  loaded.push_back(iface);
+  if (loading.empty()) {
+    std::lock_guard<std::mutex> lock(interfaces_mutex);
+    for (InterfaceDesc *done : loaded) {
+      interfaces[done->path] = done;
+    }
+    loaded.clear();
+  }
+  return iface;
 }
 
 int WindISC::workOnInclude(std::string path) {
-  WindLexer *lexer = TokenizeFile(path.c_str());
-  if (lexer == nullptr) {
+  InterfaceDesc *iface = loadInterface(path);
+  if (iface == nullptr) {
     return 1;
   }
-  WindParser *parser = new WindParser(lexer->get(), path);
-  Body *ast = parser->parse();
-  this->volatile_ast = ast;
+  this->pending = iface;
+  this->pending_once = true;
   return 0;
 }
 
@@ -77,35 +281,107 @@ int WindISC::workOnImport(std::string path) {
   if (this->workOnInclude(interface_file)) {
     return 1;
   }
+  this->pending_once = false;
   return 0;
 }
 
-Body *sumAST(Body *a, Body *b) {
-  Body *result = new Body({});
-  for (auto &child : a->get()) {
-    *result += std::unique_ptr<ASTNode>(child.get());
+/**
+ * @brief Adds an interface to the unit, with the nested ones not included yet.
+ * @param iface The interface.
+ * @param once Whether it is skipped if already included.
+ * @param into The body getting the statements and constants.
+ *
+ * Statements are shared with the cache, not copied. While an interface is
+ * parsed for the cache only the paths and constants are added.
+ */
+void WindISC::applyInterface(const InterfaceDesc *iface, bool once, Body *into) {
+  if (iface->ast == nullptr) {
+    // Still being loaded, this include closes a cycle
+    return;
   }
-  for (auto &child : b->get()) {
-    *result += std::unique_ptr<ASTNode>(child.get());
+  if (once && this->getSrcId(iface->path) != -1) {
+    return;
+  }
+  this->setPath(this->getNewSrcId(), iface->path);
+  bool append = this->building == nullptr;
+  const std::vector<ASTPtr<ASTNode>> &own = iface->ast->get();
+  size_t i = 0;
+  for (const NestedInterface &nested : iface->nested) {
+    for (; append && i < nested.at; i++) {
+      *into += ASTPtr<ASTNode>(own[i].get());
+    }
+    this->applyInterface(nested.iface, nested.once, into);
+  }
+  for (; append && i < own.size(); i++) {
+    *into += ASTPtr<ASTNode>(own[i].get());
+  }
+  for (auto &const_pair : iface->ast->consts_table) {
+    into->consts_table[const_pair.first] = const_pair.second;
+  }
+  if (!append) {
+    // The interface being parsed only records its own imports and flags
+    return;
+  }
+  for (const std::string &imp : iface->imports) {
+    this->imp_toprocess.push_back(imp);
+  }
+  for (const std::string &flag : iface->ld_flags) {
+    this->addLdFlag(flag);
   }
-  return result;
 }
 
+/**
+ * @brief Merges the interface taken by the last include into an AST.
+ * @param ast The AST of the including parser, appended to in place.
+ * @return The AST, or nullptr if nothing was included.
+ *
+ * Only the included statements and constants are touched, so a unit with
+ * many includes stays linear in its declarations. Included constants win
+ * over the ones already defined. While an interface is parsed for the
+ * cache, the nested interface is only recorded with its position, so the
+ * cached AST holds the interface's own statements.
+ */
 Body *WindISC::commitAST(Body *ast) {
-  if (this->volatile_ast == nullptr) {
+  InterfaceDesc *iface = this->pending;
+  if (iface == nullptr) {
     return nullptr;
   }
-  Body *resx = sumAST(ast, this->volatile_ast);
-  resx->consts_table = this->volatile_ast->consts_table;
-  for (auto &const_pair : ast->consts_table) {
-    resx->consts_table.insert({const_pair.first, const_pair.second});
+  this->pending = nullptr;
+  if (this->building != nullptr) {
+    this->building->nested.push_back({ast->get().size(), iface, this->pending_once});
   }
-
-  this->volatile_ast = nullptr;
-  return resx;
+  this->applyInterface(iface, false, ast);
+  return ast;
 }
 
 
 void InitISC() {
   global_isc = new WindISC();
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Parses an interface into the interface cache.
+ * @param path The interface path.
+ * @return False if the interface was already cached or failed to load.
+ *
+ * Parse errors end the process, so callers should only warm interfaces
+ * they know to be valid.
+ */
+bool WarmInterface(std::string path) {
+  {
+    std::lock_guard<std::mutex> lock(interfaces_mutex);
+    if (interfaces.count(getRealPath(path))) {
+      return false;
+    }
+  }
+  return loadInterface(path) != nullptr;
+}
+
+/**
+ * @brief Sets the cache holding precompiled interface images.
+ * @param cache The cache, or nullptr to only parse interfaces.
+ */
+void UseInterfaceImages(WindObjectCache *cache) {
+  std::lock_guard<std::mutex> lock(interfaces_mutex);
+  image_cache = cache;
+}
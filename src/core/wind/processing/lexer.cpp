@@ -5,21 +5,22 @@
 
 #include <string>
 #include <memory>
-#include <fstream>
+#include <stdexcept>
+#include <algorithm>
 #include <wind/processing/lexer.h>
 #include <wind/processing/utils.h>
+#include <wind/processing/source.h>
 #include <wind/isc/isc.h>
+#include <wind/common/timing.h>
 #include <iostream>
 
 /**
  * @brief Constructor for CharStream.
- * @param data The input data to tokenize.
+ * @param data The input data to tokenize, it must outlive the stream.
  */
-CharStream::CharStream(std::string data) {
-  this->buffer = std::make_unique<char[]>(data.size());
-  this->size = data.size() - 1; // No NULL terminator
-  std::copy(data.begin(), data.end(), this->buffer.get());
-  this->pos = std::make_pair(1,1);
+CharStream::CharStream(std::string_view data) {
+  this->buffer = data.data();
+  this->size = data.size() - 1; // Final newline
 }
 
 /**
@@ -34,18 +35,8 @@ char CharStream::current() const {
  * @brief Advances the stream by the given offset.
  * @param offset The number of characters to advance.
  */
-void CharStream::advance(u_int16_t offset) {
-  if (this->index + offset >= (this->size)) {
-    this->index+=offset;
-    return;
-  }  
+void CharStream::advance(size_t offset) {
   this->index+=offset;
-  if (this->current() == '\n') {
-    this->pos.first++;
-    this->pos.second = 1;
-  } else {
-    this->pos.second++;
-  }
 }
 
 /**
@@ -53,8 +44,8 @@ void CharStream::advance(u_int16_t offset) {
  * @param offset The offset to peek at.
  * @return The character at the given offset.
  */
-char CharStream::peek(u_int16_t offset) const {
-  if (this->index + offset >= (this->size)) {
+char CharStream::peek(size_t offset) const {
+  if (this->index + offset >= (size_t)this->size) {
     return '\0';
   }
   return this->buffer[this->index + offset];
@@ -72,27 +63,56 @@ void CharStream::reset() {
  * @return True if the stream has ended, false otherwise.
  */
 bool CharStream::end() const {
-  return this->index >= (this->size);
+  return (ssize_t)this->index >= this->size;
 }
 
 /**
- * @brief Gets the current position in the stream.
- * @return The current position.
+ * @brief Constructor for TokenStream.
+ */
+TokenStream::TokenStream() {}
+
+/**
+ * @brief Constructor for a TokenStream lexing on demand.
+ * @param source The lexer to pull tokens from.
  */
-TokenPos CharStream::position() const {
-  return this->pos;
+TokenStream::TokenStream(WindLexer *source) : tokens(RING_SIZE), source(source) {}
+
+/**
+ * @brief Checks if a token exists, lexing up to it in streaming mode.
+ * @param at The index of the token.
+ * @return True if the token exists.
+ */
+bool TokenStream::available(size_t at) const {
+  if (!this->source) {
+    return at < this->tokens.size();
+  }
+  while (at >= this->produced && !this->exhausted) {
+    if (this->source->next(this->tokens[this->produced % RING_SIZE])) {
+      this->produced++;
+    } else {
+      this->exhausted = true;
+    }
+  }
+  if (at + RING_SIZE <= this->produced) {
+    throw std::runtime_error("Token is out of the stream lookback window");
+  }
+  return at < this->produced;
 }
 
 /**
- * @brief Constructor for TokenStream.
+ * @brief Gets the storage of an available token.
+ * @param at The index of the token.
+ * @return The token.
  */
-TokenStream::TokenStream() {}
+Token *TokenStream::slot(size_t at) const {
+  return &this->tokens[this->source ? at % RING_SIZE : at];
+}
 
 /**
  * @brief Pushes a token onto the stream.
  * @param token The token to push.
  */
-void TokenStream::push(Token *token) {
+void TokenStream::push(const Token &token) {
   this->tokens.push_back(token);
 }
 
@@ -101,24 +121,25 @@ void TokenStream::push(Token *token) {
  * @return The popped token.
  */
 Token *TokenStream::pop() {
-  if (this->index >= this->tokens.size()) {
+  if (!this->available(this->index)) {
     this->index++;
     return nullptr;
   }
-  Token *token = this->tokens[this->index];
+  Token *token = this->slot(this->index);
   this->index++;
   return token;
 }
 
 /**
  * @brief Gets the last token in the stream.
- * @return The last token.
+ * @return The last token, the last lexed one in streaming mode.
  */
 Token *TokenStream::last() const {
-  if (this->tokens.size() == 0) {
+  size_t count = this->source ? this->produced : this->tokens.size();
+  if (count == 0) {
     return nullptr;
   }
-  return this->tokens[this->tokens.size() - 1];
+  return this->slot(count - 1);
 }
 
 /**
@@ -133,16 +154,16 @@ void TokenStream::reset() {
  * @return The current token.
  */
 Token *TokenStream::current() const {
-  if (this->index >= this->tokens.size()) {
+  if (!this->available(this->index)) {
     return nullptr;
   }
-  return this->tokens[this->index];
+  return this->slot(this->index);
 }
 
 /**
  * @brief Advances the token stream by one token.
  */
-void TokenStream::advance(int16_t index) {
+void TokenStream::advance(ssize_t index) {
   this->index+=index;
 }
 
@@ -151,11 +172,11 @@ void TokenStream::advance(int16_t index) {
  * @param offset The offset to peek at.
  * @return The token at the given offset.
  */
-Token *TokenStream::peek(u_int16_t offset) const {
-  if (this->index + offset >= this->tokens.size()) {
+Token *TokenStream::peek(size_t offset) const {
+  if (!this->available(this->index + offset)) {
     return nullptr;
   }
-  return this->tokens[this->index + offset];
+  return this->slot(this->index + offset);
 }
 
 /**
@@ -163,14 +184,17 @@ Token *TokenStream::peek(u_int16_t offset) const {
  * @return True if the stream has ended, false otherwise.
  */
 bool TokenStream::end() const {
-  return this->index >= this->tokens.size();
+  return !this->available(this->index);
 }
 
 /**
  * @brief Gets the vector of tokens in the stream.
  * @return The vector of tokens.
  */
-std::vector<Token*> TokenStream::getVec() const {
+const std::vector<Token> &TokenStream::getVec() const {
+  if (this->source) {
+    throw std::runtime_error("A streaming token stream has no token vector");
+  }
   return this->tokens;
 }
 
@@ -179,9 +203,10 @@ std::vector<Token*> TokenStream::getVec() const {
  * @param stream The token stream to join.
  */
 void TokenStream::join(TokenStream *stream) {
-  for (Token *token : stream->getVec()) {
-    this->push(token);
+  if (this->source || stream->source) {
+    throw std::runtime_error("Streaming token streams can't be joined");
   }
+  this->tokens.insert(this->tokens.end(), stream->tokens.begin(), stream->tokens.end());
 }
 
 /**
@@ -189,18 +214,54 @@ void TokenStream::join(TokenStream *stream) {
  * @param stream The token stream to join.
  * @param index The index after which to join the stream.
  */
-void TokenStream::joinAfterindex(TokenStream *stream, u_int16_t index) {
-  std::vector<Token*> new_tokens;
-  for (u_int16_t i = 0; i < index; i++) {
-    new_tokens.push_back(this->tokens[i]);
+void TokenStream::joinAfterindex(TokenStream *stream, size_t index) {
+  if (this->source || stream->source) {
+    throw std::runtime_error("Streaming token streams can't be joined");
+  }
+  this->tokens.insert(this->tokens.begin() + index, stream->tokens.begin(), stream->tokens.end());
+}
+
+/**
+ * @brief Gets the value of a token.
+ * @return The interned identifier, number, string content or symbol.
+ */
+const std::string &Token::value() const {
+  return global_isc->getSymbols().get(this->symbol);
+}
+
+/**
+ * @brief Gets the name of a token kind for diagnostics.
+ * @return The name, the symbol itself for symbols.
+ */
+std::string Token::name() const {
+  switch (this->type) {
+    case Token::Type::IDENTIFIER: return "Identifier";
+    case Token::Type::INTEGER: return "Integer";
+    case Token::Type::STRING: return "String";
+    default: return this->value();
   }
-  for (Token *token : stream->getVec()) {
-    new_tokens.push_back(token);
+}
+
+/**
+ * @brief Gets the range of a token in its source.
+ * @return The line and column of the first character and of the one past the token.
+ */
+TokenRange Token::range() const {
+  SourceBuffer *source = global_isc->getSource(this->srcId);
+  if (!source) {
+    return std::make_pair(std::make_pair(0, 0), std::make_pair(0, 0));
   }
-  for (u_int16_t i = index; i < this->tokens.size(); i++) {
-    new_tokens.push_back(this->tokens[i]);
+  const LineIndex &lines = source->lines();
+  if (!lines.built()) {
+    return std::make_pair(
+      SourcePosition(source->view(), this->offset),
+      SourcePosition(source->view(), this->offset + this->length)
+    );
   }
-  this->tokens = new_tokens;
+  return std::make_pair(
+    lines.position(this->offset),
+    lines.position(this->offset + this->length)
+  );
 }
 
 /**
@@ -209,189 +270,289 @@ void TokenStream::joinAfterindex(TokenStream *stream, u_int16_t index) {
  * @return The lexer for the file.
  */
 WindLexer *TokenizeFile(const char *filename) {
-  std::ifstream file(filename);
-  if (!file.is_open()) {
+  WindTimer timer("lex", filename);
+  SourceBuffer *source = SourceBuffer::Map(filename);
+  if (!source) {
     std::cerr << "Could not open file: " << filename << std::endl;
     return nullptr;
   }
-  std::string data;
-  std::string line;
-  while (std::getline(file, line)) {
-    data += line + '\n';
-  }
-  WindLexer *lex = new WindLexer(data);
+  source->indexLines();
+  WindLexer *lex = new WindLexer(source->view());
   lex->tokenize();
   global_isc->setPath(lex->srcId, getRealPath(filename));
+  global_isc->setSource(lex->srcId, source);
   global_isc->setStream(lex->srcId, lex->get());
-  global_isc->newParserReport(lex->srcId, data);
+  global_isc->newParserReport(lex->srcId, source);
   return lex;
 }
 
 /**
- * @brief Constructor for WindLexer.
- * @param data The input data to tokenize.
+ * @brief Lexes a file on demand.
+ * @param filename The name of the file to lex.
+ * @return The lexer for the file, its stream lexes as the parser reads it.
  */
-WindLexer::WindLexer(std::string data) : stream(data), reporter(new LexerReport()), tokens(new TokenStream()), source_back(data) {
+WindLexer *StreamFile(const char *filename) {
+  WindTimer timer("lex", filename);
+  SourceBuffer *source = SourceBuffer::Map(filename);
+  if (!source) {
+    std::cerr << "Could not open file: " << filename << std::endl;
+    return nullptr;
+  }
+  source->indexLines();
+  WindLexer *lex = new WindLexer(source->view(), true);
+  global_isc->setPath(lex->srcId, getRealPath(filename));
+  global_isc->setSource(lex->srcId, source);
+  global_isc->setStream(lex->srcId, lex->get());
+  global_isc->newParserReport(lex->srcId, source);
+  return lex;
+}
+
+/**
+ * @brief Constructor for WindLexer.
+ * @param data The input data to tokenize, it must outlive the lexer.
+ * @param streaming If set, tokens are lexed as the stream is read instead of by tokenize().
+ */
+WindLexer::WindLexer(std::string_view data, bool streaming) :
+  stream(data),
+  reporter(new LexerReport()),
+  tokens(streaming ? new TokenStream(this) : new TokenStream()),
+  source_back(data) {
   srcId = global_isc->getNewSrcId();
 }
 
+// SymbolTable entries by first character, longest spelling first
+struct SymbolCandidates {
+  uint8_t count = 0;
+  uint8_t index[4];
+};
+
 /**
- * @brief Matches a symbol in the input stream.
- * @return The matched symbol.
+ * @brief Gets the first character dispatch table of SymbolTable, built once.
  */
-SymbolMatch WindLexer::MatchSymbol() {
-  for (const auto &symbol : SymbolTable) {
-    std::string strsym = symbol.first;
-    bool match = true;
-    for (int i=0;i<strsym.size();i++) {
-      if (this->stream.peek(i) == strsym[i]) {
-        continue;
+static const SymbolCandidates *SymbolDispatch() {
+  static const SymbolCandidates *table = [] {
+    SymbolCandidates *table = new SymbolCandidates[256];
+    for (size_t s=0;s<SymbolTable.size();s++) {
+      SymbolCandidates &cands = table[(uint8_t)SymbolTable[s].first[0]];
+      if (cands.count == sizeof(cands.index)) {
+        throw std::runtime_error("Too many symbols sharing a first character");
       }
-      else {
-        match=false;
-        break;
+      size_t at = cands.count++;
+      while (at > 0 && SymbolTable[cands.index[at-1]].first.size() < SymbolTable[s].first.size()) {
+        cands.index[at] = cands.index[at-1];
+        at--;
       }
+      cands.index[at] = s;
+    }
+    return table;
+  }();
+  return table;
+}
+
+/**
+ * @brief Matches a symbol in the input stream, the longest one wins.
+ * @return The index of the matched symbol in SymbolTable, -1 if none.
+ */
+SymbolMatch WindLexer::MatchSymbol() {
+  const SymbolCandidates &cands = SymbolDispatch()[(uint8_t)this->stream.current()];
+  for (uint8_t c=0;c<cands.count;c++) {
+    const std::string &strsym = SymbolTable[cands.index[c]].first;
+    size_t i = 1;
+    while (i < strsym.size() && this->stream.peek(i) == strsym[i]) {
+      i++;
     }
-    if (match) {
-      return std::unique_ptr<std::pair<std::string, Token::Type>>(new std::pair<std::string, Token::Type>(symbol.first, symbol.second));
+    if (i == strsym.size()) {
+      return cands.index[c];
     }
   }
-  return nullptr;
+  return -1;
+}
+
+/**
+ * @brief Gets the source from the current position.
+ */
+std::string_view WindLexer::rest() const {
+  size_t offset = std::min(this->stream.offset(), this->source_back.size());
+  return this->source_back.substr(offset);
+}
+
+/**
+ * @brief Makes a token ending at the current position.
+ * @param type The token type.
+ * @param start The offset of the first character of the token.
+ * @param value The value to intern.
+ * @return The token.
+ */
+Token WindLexer::MakeToken(Token::Type type, size_t start, std::string_view value) {
+  return Token{
+    type,
+    this->srcId,
+    (uint32_t)start,
+    (uint32_t)(this->stream.offset() - start),
+    global_isc->getSymbols().intern(value)
+  };
 }
 
 /**
  * @brief Lexes a hexadecimal number.
  * @return The token for the hexadecimal number.
  */
-Token *WindLexer::LexHexadecimal() {
-  std::string value;
-  TokenPos start = this->stream.position();
+Token WindLexer::LexHexadecimal() {
+  size_t start = this->stream.offset();
+  bool separated = false;
   while ( LexUtils::hexadecimal(this->stream.current()) ) {
-    if ( this->stream.current() != '_')
-      value += this->stream.current();
+    separated |= this->stream.current() == '_';
     this->stream.advance();
   }
-  TokenPos end = this->stream.position();
-  end.second--;
-  return new Token(value, Token::Type::INTEGER, "Integer", std::make_pair(start, end), this->srcId);
+  std::string_view text = this->source_back.substr(start, this->stream.offset() - start);
+  if (!separated) {
+    return this->MakeToken(Token::Type::INTEGER, start, text);
+  }
+  std::string value;
+  for (char c : text) {
+    if (c != '_') value += c;
+  }
+  return this->MakeToken(Token::Type::INTEGER, start, value);
 }
 
 /**
- * @brief Lexes an identifier.
+ * @brief Lexes an identifier or a keyword.
  * @return The token for the identifier.
  */
-Token *WindLexer::LexIdentifier() {
-  std::string value;
-  TokenPos start = this->stream.position();
-  start.second--;
-  while ( LexUtils::alphanum(this->stream.current()) ) {
-    value += this->stream.current();
-    this->stream.advance();
+Token WindLexer::LexIdentifier() {
+  size_t start = this->stream.offset();
+  std::string_view rest = this->rest();
+  this->stream.advance(LexUtils::alphanumRun(rest.data(), rest.size()));
+  Token token = this->MakeToken(
+    Token::Type::IDENTIFIER, start, this->source_back.substr(start, this->stream.offset() - start)
+  );
+  // Keywords are interned first, so their symbol is their index
+  if (token.symbol < KW_COUNT) {
+    token.type = KeywordKinds[token.symbol];
   }
-  TokenPos end = this->stream.position();
-  end.second--;
-  return new Token(value, Token::Type::IDENTIFIER, "Identifier", std::make_pair(start, end), this->srcId);
+  return token;
 }
 
 /**
  * @brief Lexes a symbol.
- * @param symbol The symbol to lex.
+ * @param symbol The index of the symbol in SymbolTable.
  * @return The token for the symbol.
  */
-Token *WindLexer::LexSymbol(const SymbolMatch& symbol) {
-  std::string value = symbol->first;
-  TokenPos start = this->stream.position();
-  start.second--;
-  this->stream.advance(symbol->first.size());
-  TokenPos end = this->stream.position();
-  end.second += symbol->first.size()-2;
-  return new Token(value, symbol->second, symbol->first, std::make_pair(start, end), this->srcId);
+Token WindLexer::LexSymbol(SymbolMatch symbol) {
+  size_t start = this->stream.offset();
+  this->stream.advance(SymbolTable[symbol].first.size());
+  return Token{
+    SymbolTable[symbol].second,
+    this->srcId,
+    (uint32_t)start,
+    (uint32_t)SymbolTable[symbol].first.size(),
+    WindInterner::symbolOf(symbol)
+  };
 }
 
 /**
  * @brief Lexes a string.
  * @return The token for the string.
  */
-Token *WindLexer::LexString() {
-  std::string value;
-  TokenPos start = this->stream.position();
-  start.second--;
+Token WindLexer::LexString() {
+  size_t start = this->stream.offset();
   this->stream.advance();
-  while (this->stream.current() != '"') {
-    value += this->stream.current();
-    this->stream.advance();
+  std::string_view rest = this->rest();
+  size_t length = LexUtils::findChar(rest.data(), rest.size(), '"');
+  if (length == rest.size()) {
+    this->reporter->Report(
+      LexerReport::Type::LEXER_ERROR,
+      "Unterminated string",
+      SourcePosition(this->source_back, start)
+    );
+    this->stream.advance(length);
+    return this->MakeToken(Token::Type::STRING, start, "");
   }
-  TokenPos end = this->stream.position();
-  this->stream.advance();
-  return new Token(value, Token::Type::STRING, "String", std::make_pair(start, end), this->srcId);
+  this->stream.advance(length + 1);
+  return this->MakeToken(
+    Token::Type::STRING, start, this->source_back.substr(start + 1, this->stream.offset() - start - 2)
+  );
 }
 
 /**
  * @brief Lexes a character.
  * @return The token for the character.
  */
-Token *WindLexer::LexChar() {
-  std::string value;
-  TokenPos start = this->stream.position();
-  start.second--;
+Token WindLexer::LexChar() {
+  size_t start = this->stream.offset();
   this->stream.advance();
   while (this->stream.current() != '\'') {
-    value += this->stream.current();
     this->stream.advance();
   }
-  TokenPos end = this->stream.position();
   this->stream.advance();
-  std::string strnum = std::to_string(value[0]);
-  return new Token(strnum, Token::Type::INTEGER, "Char", std::make_pair(start, end), this->srcId);
+  char value = this->stream.offset() - start > 2 ? this->source_back[start + 1] : '\0';
+  std::string strnum = std::to_string(value);
+  return this->MakeToken(Token::Type::INTEGER, start, strnum);
 }
 
 /**
  * @brief Discriminates the next token in the input stream.
- * @return The next token.
- */
-Token *WindLexer::Discriminate() {
-  SymbolMatch is_symbol = this->MatchSymbol();
-  if ( LexUtils::digit(this->stream.current()) ) {
-    return this->LexHexadecimal();
+ * @param token Set to the next token, if any.
+ * @return True if a token was lexed.
+ */
+bool WindLexer::Discriminate(Token &token) {
+  SymbolMatch is_symbol;
+  if ( LexUtils::whitespace(this->stream.current()) ) {
+    std::string_view rest = this->rest();
+    this->stream.advance(LexUtils::whitespaceRun(rest.data(), rest.size()));
+    return false;
+  }
+  else if ( LexUtils::digit(this->stream.current()) ) {
+    token = this->LexHexadecimal();
+    return true;
   }
   else if ( LexUtils::alphanum(this->stream.current()) ) {
-    return this->LexIdentifier();
+    token = this->LexIdentifier();
+    return true;
   }
   else if ( this->stream.current() == '/' && this->stream.peek() == '/' ) {
-    while (this->stream.current() != '\n') {
-      this->stream.advance();
-    }
-    return nullptr;
+    std::string_view rest = this->rest();
+    this->stream.advance(LexUtils::findChar(rest.data(), rest.size(), '\n'));
+    return false;
   }
   else if ( this->stream.current() == '/' && this->stream.peek() == '*' ) {
     this->stream.advance(2);
-    while (this->stream.current() != '*' && this->stream.peek() != '/') {
-      this->stream.advance();
+    std::string_view rest = this->rest();
+    size_t at = 0;
+    while (true) {
+      at += LexUtils::findChar(rest.data() + at, rest.size() - at, '*');
+      if (at + 1 >= rest.size()) {
+        this->stream.advance(rest.size());
+        break;
+      }
+      if (rest[at + 1] == '/') {
+        this->stream.advance(at + 2);
+        break;
+      }
+      at++;
     }
-    this->stream.advance(2);
-    return nullptr;
+    return false;
   }
   else if (this->stream.current() == '"') {
-    return this->LexString();
+    token = this->LexString();
+    return true;
   }
   else if (this->stream.current() == '\'') {
-    return this->LexChar();
-  }
-  else if ( is_symbol != nullptr ) {
-    return this->LexSymbol(is_symbol);
+    token = this->LexChar();
+    return true;
   }
-  else if ( LexUtils::whitespace(this->stream.current()) ) {
-    this->stream.advance();
-    return nullptr;
+  else if ( (is_symbol = this->MatchSymbol()) != -1 ) {
+    token = this->LexSymbol(is_symbol);
+    return true;
   }
   else {
     this->reporter->Report(
       LexerReport::Type::LEXER_ERROR,
       "Unknown character: `" + std::string(1, this->stream.current()) + "`",
-      this->stream.position()
+      SourcePosition(this->source_back, this->stream.offset())
     );
     this->stream.advance();
-    return nullptr;
+    return false;
   }
 }
 
@@ -400,14 +561,36 @@ Token *WindLexer::Discriminate() {
  * @return The token stream.
  */
 TokenStream *WindLexer::tokenize() {
+  Token token;
   while (!this->stream.end()) {
-    Token *token = this->Discriminate();
-    if (token != nullptr) { this->tokens->push(token); }
+    if (this->Discriminate(token)) { this->tokens->push(token); }
   }
   this->reporter->handleErrors();
   return this->tokens;
 }
 
+/**
+ * @brief Lexes the next token.
+ * @param token Set to the next token, if any.
+ * @return False at the end of the input.
+ *
+ * Errors are reported as soon as they occur, the parser would otherwise
+ * report the tokens around them first.
+ */
+bool WindLexer::next(Token &token) {
+  while (!this->stream.end()) {
+    bool lexed = this->Discriminate(token);
+    if (this->reporter->failed()) {
+      this->reporter->handleErrors();
+    }
+    if (lexed) {
+      return true;
+    }
+  }
+  this->reporter->handleErrors();
+  return false;
+}
+
 /**
  * @brief Gets the token stream.
  * @return The token stream.
@@ -420,6 +603,6 @@ TokenStream *WindLexer::get() {
  * @brief Gets the source code.
  * @return The source code.
  */
-std::string WindLexer::source() const {
+std::string_view WindLexer::source() const {
   return this->source_back;
 }
\ No newline at end of file
@@ -9,15 +9,16 @@
 #include <wind/common/debug.h>
 #include <wind/isc/isc.h>
 #include <filesystem>
+#include <wind/common/timing.h>
+#include <wind/common/memory.h>
+#include <wind/bridge/arena.h>
+#include <atomic>
+#include <thread>
 
 #ifndef WIND_STD_PATH
 #define WIND_STD_PATH ""
 #endif
 
-#ifndef WIND_PKGS_PATH
-#define WIND_PKGS_PATH ""
-#endif
-
 ParserReport *GetReporter(Token *src) {
   return global_isc->getParserReport(src->srcId);
 }
@@ -28,8 +29,8 @@ WindParser::WindParser(TokenStream *stream, std::string src_path) :
   flag_holder(0),
   file_path(src_path) {}
 
-bool WindParser::isKeyword(Token *src, std::string value) {
-  if (src->type == Token::Type::IDENTIFIER && src->value == value) return true;
+bool WindParser::isKeyword(Token *src, Keyword keyword) {
+  if (src->type == Token::Type::IDENTIFIER && src->symbol == keyword) return true;
   return false;
 }
 
@@ -38,68 +39,46 @@ bool WindParser::until(Token::Type type) {
   return false;
 }
 
-std::string WindParser::typeSignature(Token::Type until, Token::Type oruntil) {
-  std::string signature = "";
-  bool first = true;
-  while (!this->until(until) && !this->until(oruntil)) {
-    Token *token = stream->pop();
-    if (isKeyword(token, "ptr") && this->stream->current()->type == Token::Type::LESS) {
-      signature += token->value;
-      signature += this->expect(Token::Type::LESS, "<")->value;
-      signature += this->typeSignature(Token::Type::IDENTIFIER);
-      signature += this->expect(Token::Type::GREATER, ">")->value;
-    } else {
-      if (first){
-        first=false;
-      } else {
-        signature += " ";
-      }
-      signature += token->value;
-    }
-  }
-  return signature;
-}
-
-std::string WindParser::typeSignature(Token::Type while_) {
-  std::string signature = "";
-
+const TypeExpr *WindParser::parseType() {
   if (this->stream->current()->type == Token::Type::LBRACKET) {
-    signature += this->expect(Token::Type::LBRACKET, "[")->value;
-    signature += this->typeSignature(Token::Type::IDENTIFIER);
+    this->expect(Token::Type::LBRACKET, "[");
+    const TypeExpr *inner = this->parseType();
+    uint32_t capacity = 0;
     if (this->stream->current()->type == Token::Type::SEMICOLON) {
-      signature += this->expect(Token::Type::SEMICOLON, ";")->value;
-      signature += this->expect(Token::Type::INTEGER, "array size")->value;
+      this->expect(Token::Type::SEMICOLON, ";");
+      capacity = fmtinttostr(this->expect(Token::Type::INTEGER, "array size")->value());
     }
-    signature += this->expect(Token::Type::RBRACKET, "]")->value;
-    return signature;
+    this->expect(Token::Type::RBRACKET, "]");
+    return TypeTable::Array(inner, capacity);
   }
-  else if (isKeyword(this->stream->current(), "ptr") && this->stream->peek()->type == Token::Type::LESS) {
-    signature += this->expect(Token::Type::IDENTIFIER, "ptr")->value;
-    signature += this->expect(Token::Type::LESS, "<")->value;
-    signature += this->typeSignature(Token::Type::IDENTIFIER);
-    signature += this->expect(Token::Type::GREATER, ">")->value;
-    return signature;
+  else if (isKeyword(this->stream->current(), KW_PTR) && this->stream->peek()->type == Token::Type::LESS) {
+    this->expect(Token::Type::IDENTIFIER, "ptr");
+    this->expect(Token::Type::LESS, "<");
+    const TypeExpr *inner = this->parseType();
+    this->expect(Token::Type::GREATER, ">");
+    return TypeTable::Pointer(inner);
   }
 
+  std::string spelling = "";
   bool first = true;
-  while (this->until(while_)) {
+  while (this->until(Token::Type::IDENTIFIER)) {
     Token *token = stream->pop();
     if (first) {
       first = false;
     } else {
-      signature += " ";
+      spelling += " ";
     }
-    signature += token->value;
+    spelling += token->value();
   }
-  return signature;
+  return TypeTable::Named(spelling);
 }
 
 
 Function *WindParser::parseFn() {
-  Token *fn_ref_tok = this->expect(Token::Type::IDENTIFIER, "func");
-  std::string name = this->expect(Token::Type::IDENTIFIER, "function name")->value;
+  TokenSrcId fn_src = this->expect(Token::Type::FUNC, "func")->srcId;
+  std::string name = this->expect(Token::Type::IDENTIFIER, "function name")->value();
   Body *fn_body = new Body({});
-  std::vector<std::string> arg_types;
+  std::vector<const TypeExpr*> arg_types;
   this->expect(Token::Type::LPAREN, "(");
   while (!this->until(Token::Type::RPAREN)) {
     if (this->stream->current()->type == Token::Type::VARDC) {
@@ -107,40 +86,130 @@ Function *WindParser::parseFn() {
       this->flag_holder |= FN_VARIADIC;
       break;
     }
-    std::string arg_name = this->expect(Token::Type::IDENTIFIER, "argument name")->value;
+    std::string arg_name = this->expect(Token::Type::IDENTIFIER, "argument name")->value();
     this->expect(Token::Type::COLON, ":");
-    std::string arg_type = this->typeSignature(Token::Type::COMMA, Token::Type::RPAREN);
+    const TypeExpr *arg_type = this->parseType();
     arg_types.push_back(arg_type);
-    *fn_body += std::unique_ptr<ASTNode>(new ArgDecl(arg_name, arg_type));
+    *fn_body += ASTPtr<ASTNode>(new ArgDecl(arg_name, arg_type));
     if (this->until(Token::Type::COMMA)) {
       this->expect(Token::Type::COMMA, ",");
     }
   }
   this->expect(Token::Type::RPAREN, ")");
   this->expect(Token::Type::COLON, ":");
-  std::string ret_type = this->typeSignature(Token::Type::IDENTIFIER);
+  const TypeExpr *ret_type = this->parseType();
   bool isDefined = this->stream->current()->type == Token::Type::LBRACE;
   if (this->stream->current()->type == Token::Type::LBRACE) {
     this->expect(Token::Type::LBRACE, "{");
-    while (!this->until(Token::Type::RBRACE)) {
-      *fn_body += std::unique_ptr<ASTNode>(
-        this->DiscriminateBody()
-      );
+    if (this->jobs > 1) {
+      this->deferBody(fn_body);
+    } else {
+      this->parseBody(fn_body);
     }
-    this->expect(Token::Type::RBRACE, "}");
   }
   else {
     this->expect(Token::Type::SEMICOLON, ";");
   }
-  Function *fn = new Function(name, ret_type, std::unique_ptr<Body>(fn_body));
+  Function *fn = new Function(name, ret_type, ASTPtr<Body>(fn_body));
   fn->isDefined = isDefined;
-  fn->metadata = std::filesystem::path(global_isc->getPath(fn_ref_tok->srcId)).filename().string();
+  fn->metadata = std::filesystem::path(global_isc->getPath(fn_src)).filename().string();
   fn->copyArgTypes(arg_types);
   fn->flags = this->flag_holder;
   this->flag_holder = 0;
   return fn;
 }
 
+/**
+ * @brief Parses the statements of a function body and its closing brace.
+ * @param fn_body The body, holding the argument declarations.
+ */
+void WindParser::parseBody(Body *fn_body) {
+  while (!this->until(Token::Type::RBRACE)) {
+    *fn_body += ASTPtr<ASTNode>(
+      this->DiscriminateBody()
+    );
+  }
+  this->expect(Token::Type::RBRACE, "}");
+}
+
+/**
+ * @brief Skips a function body by brace matching, keeping its tokens for parseDeferredBodies.
+ * @param fn_body The body, holding the argument declarations.
+ *
+ * The token after the closing brace is kept too, so lookaheads see the same
+ * tokens as when the body is parsed inline.
+ */
+void WindParser::deferBody(Body *fn_body) {
+  TokenStream *tokens = new TokenStream();
+  size_t depth = 1;
+  while (Token *token = this->stream->pop()) {
+    tokens->push(*token);
+    if (token->type == Token::Type::LBRACE) {
+      depth++;
+    } else if (token->type == Token::Type::RBRACE && --depth == 0) {
+      break;
+    }
+  }
+  if (Token *next = this->stream->current()) {
+    tokens->push(*next);
+  }
+  if (!this->consts_snapshot) {
+    this->consts_snapshot = std::make_shared<const ConstTable>(this->ast->consts_table);
+  }
+  this->deferred.push_back({fn_body, tokens, this->consts_snapshot});
+}
+
+/**
+ * @brief Parses the skipped function bodies on a pool of threads.
+ *
+ * Each body is filled in place, so the AST keeps the source order. Workers
+ * share the ISC, which only gets read once the first pass is over, and
+ * allocate in their own arenas, adopted by the arena of the unit.
+ */
+void WindParser::parseDeferredBodies() {
+  if (this->deferred.empty()) {
+    return;
+  }
+  WindISC *isc = global_isc;
+  ASTArena *arena = ASTArena::Current();
+  unsigned workers = std::min<size_t>(this->jobs, this->deferred.size());
+  std::vector<ASTArena*> arenas(workers, nullptr);
+  std::atomic<size_t> next(0);
+  std::vector<std::thread> pool;
+  for (unsigned w = 0; w < workers; w++) {
+    pool.emplace_back([this, w, isc, arena, &arenas, &next]() {
+      global_isc = isc;
+      int previous = EnterMemoryPhase(MemoryPhaseId("parse"));
+      if (arena) {
+        arenas[w] = new ASTArena();
+      }
+      ASTArena::Scope scope(arenas[w]);
+      WindParser worker(nullptr, this->file_path);
+      const ConstTable *consts = nullptr;
+      for (size_t i = next++; i < this->deferred.size(); i = next++) {
+        DeferredBody &item = this->deferred[i];
+        if (item.consts.get() != consts) {
+          consts = item.consts.get();
+          worker.ast->consts_table = *consts;
+        }
+        worker.stream = item.tokens;
+        worker.parseBody(item.body);
+        delete item.tokens;
+      }
+      LeaveMemoryPhase(MemoryPhaseId("parse"), previous);
+    });
+  }
+  for (std::thread &thread : pool) {
+    thread.join();
+  }
+  for (ASTArena *worker_arena : arenas) {
+    if (worker_arena) {
+      arena->adopt(worker_arena);
+    }
+  }
+  this->deferred.clear();
+}
+
 static Token::Type TOK_OP_LIST[]={
   Token::Type::PLUS,
   Token::Type::MINUS,
@@ -179,11 +248,11 @@ ASTNode *WindParser::parseExprLiteral(bool negative) {
   switch (this->stream->current()->type) {
     case Token::INTEGER:
       return new Literal(
-        negative ? -fmtinttostr(this->stream->pop()->value) : fmtinttostr(this->stream->pop()->value)
+        negative ? -fmtinttostr(this->stream->pop()->value()) : fmtinttostr(this->stream->pop()->value())
       );
     case Token::STRING:
       return new StringLiteral(
-        this->stream->pop()->value
+        this->stream->pop()->value()
       );
     default:
       return nullptr;
@@ -191,12 +260,12 @@ ASTNode *WindParser::parseExprLiteral(bool negative) {
 }
 
 ASTNode *WindParser::parseExprFnCall() {
-  std::string name = this->expect(Token::Type::IDENTIFIER, "function name")->value;
+  std::string name = this->expect(Token::Type::IDENTIFIER, "function name")->value();
   this->expect(Token::Type::LPAREN, "(");
-  std::vector<std::unique_ptr<ASTNode>> args;
+  std::vector<ASTPtr<ASTNode>> args;
   while (!this->until(Token::Type::RPAREN)) {
     ASTNode *arg = this->parseExpr(0);
-    args.push_back(std::unique_ptr<ASTNode>(arg));
+    args.push_back(ASTPtr<ASTNode>(arg));
     if (this->until(Token::Type::COMMA)) {
       this->expect(Token::Type::COMMA, ",");
     }
@@ -213,45 +282,49 @@ ASTNode *WindParser::parseExprPrimary() {
     case Token::INTEGER:
       return this->parseExprLiteral();
 
+    case Token::TRUE_LIT:
+      this->stream->pop();
+      return new Literal(1);
+
+    case Token::FALSE_LIT:
+    case Token::NULL_LIT:
+      this->stream->pop();
+      return new Literal(0);
+
+    case Token::GUARD:
+    case Token::SIZEOF:
     case Token::IDENTIFIER: {
-      if (isKeyword(this->stream->current(), "true")) {
-        this->stream->pop();
-        return new Literal(1);
-      } else if (isKeyword(this->stream->current(), "false") || isKeyword(this->stream->current(), "Null")) {
-        this->stream->pop();
-        return new Literal(0);
-      }
-      else if (isKeyword(this->stream->current(), "guard") && this->stream->peek()->type == Token::Type::NOT) {
+      if (this->stream->current()->type == Token::GUARD && this->stream->peek()->type == Token::Type::NOT) {
         // ptr guard
-        this->expect(Token::Type::IDENTIFIER, "guard");
+        this->expect(Token::Type::GUARD, "guard");
         this->expect(Token::Type::NOT, "!");
         this->expect(Token::Type::LBRACKET, "[");
         ASTNode *value = this->parseExpr(0);
         this->expect(Token::Type::RBRACKET, "]");
         return new PtrGuard(
-          std::unique_ptr<ASTNode>(value)
+          ASTPtr<ASTNode>(value)
         );
       }
-      else if (isKeyword(this->stream->current(), "sizeof") && this->stream->peek()->type == Token::Type::LESS) {
+      else if (this->stream->current()->type == Token::SIZEOF && this->stream->peek()->type == Token::Type::LESS) {
         // sizeof
-        this->expect(Token::Type::IDENTIFIER, "sizeof");
+        this->expect(Token::Type::SIZEOF, "sizeof");
         this->expect(Token::Type::LESS, "<");
-        std::string type = this->typeSignature(Token::Type::GREATER, Token::Type::GREATER);
+        const TypeExpr *type = this->parseType();
         this->expect(Token::Type::GREATER, ">");
         return new SizeOf(
           type
         );
       }
       else if (
-        this->ast->consts_table.find(this->stream->current()->value) != this->ast->consts_table.end()
+        this->ast->consts_table.find(this->stream->current()->value()) != this->ast->consts_table.end()
       ) {
-        return this->ast->consts_table[this->stream->pop()->value];
+        return this->ast->consts_table[this->stream->pop()->value()];
       }
 
       if (this->stream->peek()->type == Token::LPAREN) {
         return this->parseExprFnCall();
       } else if (this->stream->peek()->type == Token::LBRACKET) {
-        std::string name = this->stream->pop()->value;
+        std::string name = this->stream->pop()->value();
         this->expect(Token::Type::LBRACKET, "[");
         ASTNode *index = this->parseExpr(0);
         this->expect(Token::Type::RBRACKET, "]");
@@ -261,7 +334,7 @@ ASTNode *WindParser::parseExprPrimary() {
       }
       else {
         return new VariableRef(
-          this->stream->pop()->value
+          this->stream->pop()->value()
         );
       }
     }
@@ -269,7 +342,7 @@ ASTNode *WindParser::parseExprPrimary() {
     case Token::AND : {
       this->expect(Token::Type::AND, "&");
       return new VarAddressing(
-        this->expect(Token::Type::IDENTIFIER, "variable name")->value
+        this->expect(Token::Type::IDENTIFIER, "variable name")->value()
       );
     }
 
@@ -286,8 +359,8 @@ ASTNode *WindParser::parseExprPrimary() {
         return this->parseExprLiteral(true);
       } else {
         return new BinaryExpr(
-          std::unique_ptr<ASTNode>(new Literal(0)),
-          std::unique_ptr<ASTNode>(this->parseExprPrimary()),
+          ASTPtr<ASTNode>(new Literal(0)),
+          ASTPtr<ASTNode>(this->parseExprPrimary()),
           "-"
         );
       }
@@ -295,8 +368,7 @@ ASTNode *WindParser::parseExprPrimary() {
   
     default:
       Token *token = this->stream->pop();
-      GetReporter(token)->Report(ParserReport::PARSER_ERROR, new Token(
-      token->value, token->type, "Nothing (Unexpected token in expression)", token->range, token->srcId), token);
+      GetReporter(token)->Report(ParserReport::PARSER_ERROR, token->type, "Nothing (Unexpected token in expression)", token);
       return nullptr;
   }
 }
@@ -314,8 +386,8 @@ ASTNode *WindParser::parseExpr(int precedence) {
     ASTNode *index = this->parseExpr(0);
     this->expect(Token::Type::RBRACKET, "]");
     enode = new GenericIndexing(
-      std::unique_ptr<ASTNode>(index),
-      std::unique_ptr<ASTNode>(enode)
+      ASTPtr<ASTNode>(index),
+      ASTPtr<ASTNode>(enode)
     );
     enode = this->parseExprBinOp(enode, precedence);
   }
@@ -367,36 +439,37 @@ int getOpPrecedence(Token *tok) {
 
 ASTNode *WindParser::parseExprBinOp(ASTNode *left, int precedence) {
   while (this->stream->current() && tokIsOperator(this->stream->current())) {
-    Token *op = this->stream->pop();
-    int new_precedence = getOpPrecedence(op);
+    // Copied, the operand can outlast the stream's lookback window
+    Token op = *this->stream->pop();
+    int new_precedence = getOpPrecedence(&op);
 
     if (new_precedence < precedence) {
       break;
     }
 
     ASTNode *right;
-    if (op->type == Token::Type::INCREMENT) {
+    if (op.type == Token::Type::INCREMENT) {
       right = new Literal(1);
       left = new BinaryExpr(
-        std::unique_ptr<ASTNode>(left),
-        std::unique_ptr<ASTNode>(right),
+        ASTPtr<ASTNode>(left),
+        ASTPtr<ASTNode>(right),
         "+="
       );
       continue;
     }
-    else if (op->type == Token::Type::DECREMENT) {
+    else if (op.type == Token::Type::DECREMENT) {
       right = new Literal(1);
       left = new BinaryExpr(
-        std::unique_ptr<ASTNode>(left),
-        std::unique_ptr<ASTNode>(right),
+        ASTPtr<ASTNode>(left),
+        ASTPtr<ASTNode>(right),
         "-="
       );
       continue;
     }
-    else if (op->type == Token::Type::CAST_SYMBOL) {
+    else if (op.type == Token::Type::CAST_SYMBOL) {
       left = new TypeCast(
-        this->typeSignature(Token::Type::IDENTIFIER),
-        std::unique_ptr<ASTNode>(left)
+        this->parseType(),
+        ASTPtr<ASTNode>(left)
       );
       continue;
     }
@@ -410,43 +483,43 @@ ASTNode *WindParser::parseExprBinOp(ASTNode *left, int precedence) {
     }
 
     left = new BinaryExpr(
-      std::unique_ptr<ASTNode>(left),
-      std::unique_ptr<ASTNode>(right),
-      op->value
+      ASTPtr<ASTNode>(left),
+      ASTPtr<ASTNode>(right),
+      op.value()
     );
   }
   return left;
 }
 
 Return *WindParser::parseRet() {
-  this->expect(Token::Type::IDENTIFIER, "return");
+  this->expect(Token::Type::RETURN, "return");
   ASTNode *ret_expr=nullptr;
   if (stream->current()->type != Token::Type::SEMICOLON) {
     ret_expr = this->parseExprSemi();
   } else {
     this->expect(Token::Type::SEMICOLON, ";");
   }
-  return new Return(std::unique_ptr<ASTNode>(ret_expr));
+  return new Return(ASTPtr<ASTNode>(ret_expr));
 }
 
 VariableDecl *WindParser::parseVarDecl() {
-  this->expect(Token::Type::IDENTIFIER, "var");
+  this->expect(Token::Type::VAR, "var");
   std::vector<std::string> names;
   if (this->stream->current()->type == Token::Type::LBRACKET) {
     // Multi declaration
     this->expect(Token::Type::LBRACKET, "[");
     while (!this->until(Token::Type::RBRACKET)) {
-      names.push_back(this->expect(Token::Type::IDENTIFIER, "variable name")->value);
+      names.push_back(this->expect(Token::Type::IDENTIFIER, "variable name")->value());
       if (this->until(Token::Type::COMMA)) {
         this->expect(Token::Type::COMMA, ",");
       }
     }
     this->expect(Token::Type::RBRACKET, "]");
   } else {
-    names.push_back(this->expect(Token::Type::IDENTIFIER, "variable name")->value);
+    names.push_back(this->expect(Token::Type::IDENTIFIER, "variable name")->value());
   }
   this->expect(Token::Type::COLON, ":");
-  std::string type = this->typeSignature(Token::Type::IDENTIFIER);
+  const TypeExpr *type = this->parseType();
   ASTNode *expr = nullptr;
   if (this->stream->current()->type == Token::Type::ASSIGN) {
     this->expect(Token::Type::ASSIGN, "=");
@@ -455,7 +528,7 @@ VariableDecl *WindParser::parseVarDecl() {
   else {
     this->expect(Token::Type::SEMICOLON, ";");
   }
-  return new VariableDecl(names, type, std::unique_ptr<ASTNode>(expr));
+  return new VariableDecl(names, type, ASTPtr<ASTNode>(expr));
 }
 
 static std::map<std::string, FnFlags> FLAGS_MAP = {
@@ -486,139 +559,123 @@ void WindParser::pathWorkInclude(std::string relative, Token *token_ref) {
       path = std::filesystem::path(getExeDir()).append(path).string();
     }
   }
+  WindTimer timer("include", path);
   int srcId = global_isc->getSrcId(path);
   if (srcId == -1) {
     if (global_isc->workOnInclude(path)) {
-      GetReporter(token_ref)->Report(ParserReport::PARSER_ERROR, new Token(
-        token_ref->value, token_ref->type, "Nothing Failed to include: " + path, token_ref->range, token_ref->srcId
-      ), token_ref);
+      GetReporter(token_ref)->Report(ParserReport::PARSER_ERROR, token_ref->type, "Nothing Failed to include: " + path, token_ref);
     }
     Body *commit_diff = global_isc->commitAST(this->ast);
     if (commit_diff != nullptr) {
       this->ast = commit_diff;
+      this->consts_snapshot.reset();
     }
   }
   else {
-    /* GetReporter(token_ref)->Report(ParserReport::PARSER_WARNING, new Token(
-      token_ref->value, token_ref->type, "Nothing (Already included)", token_ref->range, token_ref->srcId
-    ), token_ref); */
+    /* GetReporter(token_ref)->Report(ParserReport::PARSER_WARNING, token_ref->type, "Nothing (Already included)", token_ref); */
   }
 }
 
 void WindParser::pathWorkImport(std::string relative, Token *token_ref) {
-  std::string path;
-  if (relative[0] != '#') {
-    std::string this_path = global_isc->getPath(token_ref->srcId);
-    std::string folder = std::filesystem::path(this_path).parent_path().string();
-    path = std::filesystem::path(folder).append(relative).string();
-  } else {
-    path = std::filesystem::path(WIND_PKGS_PATH).append(relative.substr(1)).string();
-    if (path[0] != '/') {
-      path = std::filesystem::path(getExeDir()).append(path).string();
-    }
-  }
+  std::string path = resolveImportPath(relative, global_isc->getPath(token_ref->srcId));
+  WindTimer timer("import", path);
   int srcId = global_isc->getSrcId(path);
   if (srcId == -1) {
     if (global_isc->workOnImport(path)) {
-      GetReporter(token_ref)->Report(ParserReport::PARSER_ERROR, new Token(
-        token_ref->value, token_ref->type, "Nothing, Failed to import: " + path , token_ref->range, token_ref->srcId
-      ), token_ref);
+      GetReporter(token_ref)->Report(ParserReport::PARSER_ERROR, token_ref->type, "Nothing, Failed to import: " + path, token_ref);
     }
     Body *commit_diff = global_isc->commitAST(this->ast);
     if (commit_diff != nullptr) {
       this->ast = commit_diff;
+      this->consts_snapshot.reset();
     }
   }
   else {
-    /* GetReporter(token_ref)->Report(ParserReport::PARSER_WARNING, new Token(
-      token_ref->value, token_ref->type, "Nothing (Already included)", token_ref->range, token_ref->srcId
-    ), token_ref); */
+    /* GetReporter(token_ref)->Report(ParserReport::PARSER_WARNING, token_ref->type, "Nothing (Already included)", token_ref); */
   }
 }
 
 ASTNode* WindParser::parseMacro() {
   this->expect(Token::Type::AT, "@");
-  Token *macro_tok = this->expect(Token::Type::IDENTIFIER, "macro name");
-  std::string name = macro_tok->value;
+  Token macro_tok = *this->expect(Token::Type::IDENTIFIER, "macro name");
+  TokenSymbol name = macro_tok.symbol;
 
-  if (name == "pure") {
+  if (name == KW_PURE) {
     this->expect(Token::Type::LBRACKET, "[");
     while (!this->until(Token::Type::RBRACKET)) {
       Token *flag = this->expect(Token::Type::IDENTIFIER, "flag");
-      FnFlags flagged= macroIntoFlag(flag->value);
+      FnFlags flagged= macroIntoFlag(flag->value());
       if (flagged) {
         this->flag_holder |= flagged;
       } else {
-        GetReporter(flag)->Report(ParserReport::PARSER_ERROR, new Token(
-          flag->value, flag->type, "Nothing (Unexpected flag)", flag->range, flag->srcId), flag);
+        GetReporter(flag)->Report(ParserReport::PARSER_ERROR, flag->type, "Nothing (Unexpected flag)", flag);
       }
     }
     this->expect(Token::Type::RBRACKET, "]");
   }
-  else if (name == "extern") {
+  else if (name == KW_EXTERN) {
     this->flag_holder |= FN_EXTERN;
   }
-  else if (name == "pub") {
+  else if (name == KW_PUB) {
     this->flag_holder |= FN_PUBLIC;
   }
-  else if (name == "include") {
+  else if (name == KW_INCLUDE) {
     if (this->stream->current()->type != Token::Type::LBRACKET) {
       Token *path = this->expect(Token::Type::STRING, "include path");
-      this->pathWorkInclude(path->value, macro_tok);
+      this->pathWorkInclude(path->value(), &macro_tok);
     } else {
       this->expect(Token::Type::LBRACKET, "[");
       while (!this->until(Token::Type::RBRACKET)) {
         Token *path = this->expect(Token::Type::STRING, "include path");
-        this->pathWorkInclude(path->value, path);
+        this->pathWorkInclude(path->value(), path);
       }
       this->expect(Token::Type::RBRACKET, "]");
     }
   }
-  else if (name == "import") {
+  else if (name == KW_IMPORT) {
     if (this->stream->current()->type != Token::Type::LBRACKET) {
       Token *path = this->expect(Token::Type::STRING, "import path");
-      this->pathWorkImport(path->value, macro_tok);
+      this->pathWorkImport(path->value(), &macro_tok);
     } else {
       this->expect(Token::Type::LBRACKET, "[");
       while (!this->until(Token::Type::RBRACKET)) {
         Token *path = this->expect(Token::Type::STRING, "import path");
-        this->pathWorkImport(path->value, path);
+        this->pathWorkImport(path->value(), path);
       }
       this->expect(Token::Type::RBRACKET, "]");
     }
   }
-  else if (name == "linkflag") {
+  else if (name == KW_LINKFLAG) {
     this->expect(Token::Type::LPAREN, "(");
     while (!this->until(Token::Type::RPAREN)) {
       Token *flag = this->expect(Token::Type::STRING, "link flag");
-      global_isc->addLdFlag(flag->value);
+      global_isc->addLdFlag(flag->value());
     }
     this->expect(Token::Type::RPAREN, ")");
   }
-  else if (name == "type") {
-    std::string type = this->typeSignature(Token::Type::IDENTIFIER);
+  else if (name == KW_TYPE) {
+    std::string type = this->parseType()->str();
     this->expect(Token::Type::ASSIGN, "=");
-    std::string value = this->typeSignature(Token::Type::IDENTIFIER);
+    const TypeExpr *value = this->parseType();
     this->expect(Token::Type::SEMICOLON, ";");
     return new TypeDecl(type, value);
   }
-  else if (name == "const") {
-    std::string c_name = this->expect(Token::Type::IDENTIFIER, "const name")->value;
+  else if (name == KW_CONST) {
+    std::string c_name = this->expect(Token::Type::IDENTIFIER, "const name")->value();
     this->expect(Token::Type::ASSIGN, "=");
     ASTNode *expr = this->parseExprSemi();
     this->ast->consts_table[c_name] = expr;
+    this->consts_snapshot.reset();
   }
   else {
     Token *token = stream->pop();
-    GetReporter(token)->Report(ParserReport::PARSER_ERROR, new Token(
-      token->value, token->type, "Nothing (Unexpected macro)", token->range, token->srcId
-    ), token);
+    GetReporter(token)->Report(ParserReport::PARSER_ERROR, token->type, "Nothing (Unexpected macro)", token);
   }
   return nullptr;
 }
 
 InlineAsm *WindParser::parseInlAsm() {
-  this->expect(Token::Type::IDENTIFIER, "asm");
+  this->expect(Token::Type::ASM, "asm");
   this->expect (Token::Type::LBRACE, "{");
   std::string code="";
   while (!this->until(Token::Type::RBRACE)) {
@@ -627,7 +684,7 @@ InlineAsm *WindParser::parseInlAsm() {
       code += "\n";
     }
     else {
-      code += token->value;
+      code += token->value();
       if (this->stream->current()->type != Token::Type::COMMA && token->type != Token::Type::QMARK) {
         code += " ";
       }
@@ -643,14 +700,14 @@ Body *WindParser::parseBranchBody() {
   if (this->stream->current()->type == Token::Type::LBRACE) {
     this->expect(Token::Type::LBRACE, "{");
     while (!this->until(Token::Type::RBRACE)) {
-      *branch_body += std::unique_ptr<ASTNode>(
+      *branch_body += ASTPtr<ASTNode>(
         this->DiscriminateBody()
       );
     }
     this->expect(Token::Type::RBRACE, "}");
   }
   else {
-    *branch_body += std::unique_ptr<ASTNode>(
+    *branch_body += ASTPtr<ASTNode>(
       this->DiscriminateBody()
     );
   }
@@ -658,13 +715,13 @@ Body *WindParser::parseBranchBody() {
 }
 
 Branching *WindParser::parseBranch() {
-  this->expect(Token::Type::IDENTIFIER, "branch");
+  this->expect(Token::Type::BRANCH, "branch");
   Branching *branch = new Branching();
   this->expect(Token::Type::LBRACKET, "[");
   while (!this->until(Token::Type::RBRACKET)) {
     // else
-    if (this->isKeyword(stream->current(), "else")) {
-      this->expect(Token::Type::IDENTIFIER, "else");
+    if (stream->current()->type == Token::Type::ELSE) {
+      this->expect(Token::Type::ELSE, "else");
       this->expect(Token::Type::COLON, ":");
       branch->setElseBranch(this->parseBranchBody());
       break;
@@ -675,8 +732,8 @@ Branching *WindParser::parseBranch() {
     else {
       ASTNode *condition = this->parseExprColon();
       branch->addBranch(
-        std::unique_ptr<ASTNode>(condition),
-        std::unique_ptr<Body>(this->parseBranchBody())
+        ASTPtr<ASTNode>(condition),
+        ASTPtr<Body>(this->parseBranchBody())
       );
     }
   }
@@ -685,7 +742,7 @@ Branching *WindParser::parseBranch() {
 }
 
 Looping *WindParser::parseLoop() {
-  this->expect(Token::Type::IDENTIFIER, "loop");
+  this->expect(Token::Type::LOOP, "loop");
   this->expect(Token::Type::LBRACKET, "[");
   Looping *loop = new Looping();
   loop->setCondition(this->parseExpr(0));
@@ -696,14 +753,14 @@ Looping *WindParser::parseLoop() {
 
 
 GlobalDecl *WindParser::parseGlobDecl() {
-  this->expect(Token::Type::IDENTIFIER, "global");
-  std::string name = this->expect(Token::Type::IDENTIFIER, "variable name")->value;
+  this->expect(Token::Type::GLOBAL, "global");
+  std::string name = this->expect(Token::Type::IDENTIFIER, "variable name")->value();
   this->expect(Token::Type::COLON, ":");
-  std::string type = this->typeSignature(Token::Type::IDENTIFIER);
+  const TypeExpr *type = this->parseType();
   if (this->stream->current()->type == Token::Type::ASSIGN) {
     this->expect(Token::Type::ASSIGN, "=");
     ASTNode *expr = this->parseExprSemi();
-    return new GlobalDecl(name, type, std::unique_ptr<ASTNode>(expr));
+    return new GlobalDecl(name, type, ASTPtr<ASTNode>(expr));
   }
   else {
     this->expect(Token::Type::SEMICOLON, ";");
@@ -713,11 +770,11 @@ GlobalDecl *WindParser::parseGlobDecl() {
 
 TryCatch *WindParser::parseTryCatch() {
   TryCatch *try_catch = new TryCatch();
-  this->expect(Token::Type::IDENTIFIER, "try");
+  this->expect(Token::Type::TRY, "try");
   this->expect(Token::Type::LBRACE, "{");
   Body *try_body = new Body({});
   while (!this->until(Token::Type::RBRACE)) {
-    *try_body += std::unique_ptr<ASTNode>(
+    *try_body += ASTPtr<ASTNode>(
       this->DiscriminateBody()
     );
   }
@@ -727,25 +784,25 @@ TryCatch *WindParser::parseTryCatch() {
   this->stream->advance(-1);
   while (this->stream->current()->type == Token::Type::LBRACKET) {
     this->expect(Token::Type::LBRACKET, "[");
-    std::string block_name = this->expect(Token::Type::IDENTIFIER, "catch block name")->value;
+    std::string block_name = this->expect(Token::Type::IDENTIFIER, "catch block name")->value();
     this->expect(Token::Type::RBRACKET, "]");
     this->expect(Token::Type::ARROW, "->");
     this->expect(Token::Type::LBRACE, "{");
     Body *catch_body = new Body({});
     while (!this->until(Token::Type::RBRACE)) {
-      *catch_body += std::unique_ptr<ASTNode>(
+      *catch_body += ASTPtr<ASTNode>(
         this->DiscriminateBody()
       );
     }
     this->expect(Token::Type::RBRACE, "}");
     try_catch->addCatchBlock(block_name, catch_body);
   }
-  if (this->isKeyword(stream->current(), "finally")) {
-    this->expect(Token::Type::IDENTIFIER, "finally");
+  if (stream->current()->type == Token::Type::FINALLY) {
+    this->expect(Token::Type::FINALLY, "finally");
     this->expect(Token::Type::LBRACE, "{");
     Body *finally_body = new Body({});
     while (!this->until(Token::Type::RBRACE)) {
-      *finally_body += std::unique_ptr<ASTNode>(
+      *finally_body += ASTPtr<ASTNode>(
         this->DiscriminateBody()
       );
     }
@@ -756,95 +813,82 @@ TryCatch *WindParser::parseTryCatch() {
 }
 
 ASTNode *WindParser::DiscriminateTop() {
-  if (this->isKeyword(stream->current(), "func")) {
-    return this->parseFn();
-  }
-  else if (this->isKeyword(stream->current(), "global")) {
-    return this->parseGlobDecl();
-  }
-  else if (this->stream->current()->type == Token::Type::AT) {
-    return this->parseMacro();
-  }
-  else {
-    Token *token = stream->current();
-    GetReporter(token)->Report(ParserReport::PARSER_ERROR, new Token(
-      token->value, token->type, "Nothing (Unexpected combination)", token->range, token->srcId
-    ), token);
+  switch (stream->current()->type) {
+    case Token::Type::FUNC:
+      return this->parseFn();
+    case Token::Type::GLOBAL:
+      return this->parseGlobDecl();
+    case Token::Type::AT:
+      return this->parseMacro();
+    default: {
+      Token *token = stream->current();
+      GetReporter(token)->Report(ParserReport::PARSER_ERROR, token->type, "Nothing (Unexpected combination)", token);
+    }
   }
   return nullptr;
 }
 
 ASTNode *WindParser::DiscriminateBody() {
-  if (this->isKeyword(stream->current(), "return")) {
-    return this->parseRet();
-  }
-  else if (this->isKeyword(stream->current(), "var")) {
-    return this->parseVarDecl();
-  }
-  else if (this->isKeyword(stream->current(), "asm")) {
-    return this->parseInlAsm();
-  } 
-  else if (this->isKeyword(stream->current(), "branch")) {
-    return this->parseBranch();
-  }
-  else if (this->isKeyword(stream->current(), "loop")) {
-    return this->parseLoop();
-  }
-  else if (this->isKeyword(stream->current(), "break")) {
-    this->expect(Token::Type::IDENTIFIER, "break");
-    this->expect(Token::Type::SEMICOLON, ";");
-    return new Break();
-  }
-  else if (this->isKeyword(stream->current(), "continue")) {
-    this->expect(Token::Type::IDENTIFIER, "continue");
-    this->expect(Token::Type::SEMICOLON, ";");
-    return new Continue();
-  }
-  else if (this->isKeyword(stream->current(), "try")) {
-    return this->parseTryCatch();
-  }
-  else {
-    return this->parseExprSemi();
+  switch (stream->current()->type) {
+    case Token::Type::RETURN:
+      return this->parseRet();
+    case Token::Type::VAR:
+      return this->parseVarDecl();
+    case Token::Type::ASM:
+      return this->parseInlAsm();
+    case Token::Type::BRANCH:
+      return this->parseBranch();
+    case Token::Type::LOOP:
+      return this->parseLoop();
+    case Token::Type::BREAK:
+      this->expect(Token::Type::BREAK, "break");
+      this->expect(Token::Type::SEMICOLON, ";");
+      return new Break();
+    case Token::Type::CONTINUE:
+      this->expect(Token::Type::CONTINUE, "continue");
+      this->expect(Token::Type::SEMICOLON, ";");
+      return new Continue();
+    case Token::Type::TRY:
+      return this->parseTryCatch();
+    default:
+      return this->parseExprSemi();
   }
 }
 
 Body *WindParser::parse() {
+  WindTimer timer("parse", this->file_path);
   while (!stream->end()) {
     ASTNode *node = this->DiscriminateTop();
     if (!node) continue;
-    *this->ast += std::unique_ptr<ASTNode>(
+    *this->ast += ASTPtr<ASTNode>(
       node
     );
   }
+  this->parseDeferredBodies();
   return ast;
 }
 
 Token* WindParser::expect(Token::Type type, std::string str_repr) {
   Token *token = stream->pop();
-  if (token->type != type) {
-    GetReporter(token)->Report(ParserReport::PARSER_ERROR, new Token(
-      token->value, type, str_repr, token->range, token->srcId
-    ), token);
+  // Keywords are still accepted where a name is expected
+  if (token->type != type && !(type == Token::Type::IDENTIFIER && token->isKeyword())) {
+    GetReporter(token)->Report(ParserReport::PARSER_ERROR, type, str_repr, token);
   }
   return token;
 }
 
 Token* WindParser::expect(std::string value, std::string str_repr) {
   Token *token = stream->pop();
-  if (token->value != value) {
-    GetReporter(token)->Report(ParserReport::PARSER_ERROR, new Token(
-      value, token->type, str_repr, token->range, token->srcId
-    ), token);
+  if (token->value() != value) {
+    GetReporter(token)->Report(ParserReport::PARSER_ERROR, token->type, str_repr, token);
   }
   return token;
 }
 
 Token *WindParser::expect(Token::Type type, std::string value, std::string str_repr) {
   Token *token = stream->pop();
-  if (token->type != type || token->value != value) {
-    GetReporter(token)->Report(ParserReport::PARSER_ERROR, new Token(
-      value, type, str_repr, token->range, token->srcId
-    ), token);
+  if (token->type != type || token->value() != value) {
+    GetReporter(token)->Report(ParserReport::PARSER_ERROR, type, str_repr, token);
   }
   return token;
 }
@@ -0,0 +1,206 @@
+/**
+ * @file scan.cpp
+ * @brief Vectorized character class scans for the lexer.
+ *
+ * Each scan has an AVX2 and an SSE2 kernel on x86-64, picked once through
+ * CPUID, and a scalar version used for the tails and on other targets.
+ */
+
+#include <wind/processing/utils.h>
+#include <stdint.h>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Scalar whitespace run.
+ */
+static size_t whitespaceRunScalar(const char *s, size_t n) {
+  size_t i = 0;
+  while (i < n && LexUtils::whitespace(s[i])) i++;
+  return i;
+}
+
+/**
+ * @brief Scalar identifier run.
+ */
+static size_t alphanumRunScalar(const char *s, size_t n) {
+  size_t i = 0;
+  while (i < n && LexUtils::alphanum(s[i])) i++;
+  return i;
+}
+
+/**
+ * @brief Scalar character search.
+ */
+static size_t findCharScalar(const char *s, size_t n, char c) {
+  size_t i = 0;
+  while (i < n && s[i] != c) i++;
+  return i;
+}
+
+#if defined(__x86_64__)
+
+// Bytes are signed in the compares, so anything >= 0x80 is below every range
+
+/**
+ * @brief SSE2 mask of the whitespace bytes in a block.
+ */
+static inline uint32_t whitespaceMask16(__m128i v) {
+  __m128i ws = _mm_or_si128(
+    _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))),
+    _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\r')))
+  );
+  return _mm_movemask_epi8(ws);
+}
+
+/**
+ * @brief SSE2 mask of the identifier bytes in a block.
+ */
+static inline uint32_t alphanumMask16(__m128i v) {
+  __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+  __m128i alpha = _mm_and_si128(
+    _mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1))
+  );
+  __m128i digit = _mm_and_si128(
+    _mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1))
+  );
+  __m128i under = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+  return _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(alpha, digit), under));
+}
+
+static size_t whitespaceRunSSE2(const char *s, size_t n) {
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    uint32_t miss = ~whitespaceMask16(_mm_loadu_si128((const __m128i*)(s + i))) & 0xffff;
+    if (miss) return i + __builtin_ctz(miss);
+  }
+  return i + whitespaceRunScalar(s + i, n - i);
+}
+
+static size_t alphanumRunSSE2(const char *s, size_t n) {
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    uint32_t miss = ~alphanumMask16(_mm_loadu_si128((const __m128i*)(s + i))) & 0xffff;
+    if (miss) return i + __builtin_ctz(miss);
+  }
+  return i + alphanumRunScalar(s + i, n - i);
+}
+
+static size_t findCharSSE2(const char *s, size_t n, char c) {
+  size_t i = 0;
+  __m128i needle = _mm_set1_epi8(c);
+  for (; i + 16 <= n; i += 16) {
+    uint32_t hit = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(s + i)), needle));
+    if (hit) return i + __builtin_ctz(hit);
+  }
+  return i + findCharScalar(s + i, n - i, c);
+}
+
+__attribute__((target("avx2")))
+static inline uint32_t whitespaceMask32(__m256i v) {
+  __m256i ws = _mm256_or_si256(
+    _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))),
+    _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')))
+  );
+  return _mm256_movemask_epi8(ws);
+}
+
+__attribute__((target("avx2")))
+static inline uint32_t alphanumMask32(__m256i v) {
+  __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+  __m256i alpha = _mm256_and_si256(
+    _mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), lower)
+  );
+  __m256i digit = _mm256_and_si256(
+    _mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), v)
+  );
+  __m256i under = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_'));
+  return _mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(alpha, digit), under));
+}
+
+__attribute__((target("avx2")))
+static size_t whitespaceRunAVX2(const char *s, size_t n) {
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    uint32_t miss = ~whitespaceMask32(_mm256_loadu_si256((const __m256i*)(s + i)));
+    if (miss) return i + __builtin_ctz(miss);
+  }
+  return i + whitespaceRunSSE2(s + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static size_t alphanumRunAVX2(const char *s, size_t n) {
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    uint32_t miss = ~alphanumMask32(_mm256_loadu_si256((const __m256i*)(s + i)));
+    if (miss) return i + __builtin_ctz(miss);
+  }
+  return i + alphanumRunSSE2(s + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static size_t findCharAVX2(const char *s, size_t n, char c) {
+  size_t i = 0;
+  __m256i needle = _mm256_set1_epi8(c);
+  for (; i + 32 <= n; i += 32) {
+    uint32_t hit = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(s + i)), needle));
+    if (hit) return i + __builtin_ctz(hit);
+  }
+  return i + findCharSSE2(s + i, n - i, c);
+}
+
+#endif
+
+struct ScanKernels {
+  size_t (*whitespaceRun)(const char*, size_t);
+  size_t (*alphanumRun)(const char*, size_t);
+  size_t (*findChar)(const char*, size_t, char);
+};
+
+/**
+ * @brief Picks the widest kernels the CPU supports, once.
+ */
+static const ScanKernels &Kernels() {
+  static const ScanKernels kernels = [] {
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+      return ScanKernels{whitespaceRunAVX2, alphanumRunAVX2, findCharAVX2};
+    }
+    return ScanKernels{whitespaceRunSSE2, alphanumRunSSE2, findCharSSE2};
+#else
+    return ScanKernels{whitespaceRunScalar, alphanumRunScalar, findCharScalar};
+#endif
+  }();
+  return kernels;
+}
+
+/**
+ * @brief Gets the length of the whitespace run at the start of a buffer.
+ * @param s The buffer.
+ * @param n The number of readable bytes.
+ */
+size_t LexUtils::whitespaceRun(const char *s, size_t n) {
+  return Kernels().whitespaceRun(s, n);
+}
+
+/**
+ * @brief Gets the length of the identifier characters run at the start of a buffer.
+ * @param s The buffer.
+ * @param n The number of readable bytes.
+ */
+size_t LexUtils::alphanumRun(const char *s, size_t n) {
+  return Kernels().alphanumRun(s, n);
+}
+
+/**
+ * @brief Finds a character in a buffer.
+ * @param s The buffer.
+ * @param n The number of readable bytes.
+ * @param c The character.
+ * @return Its offset, n if missing.
+ */
+size_t LexUtils::findChar(const char *s, size_t n, char c) {
+  return Kernels().findChar(s, n, c);
+}
@@ -0,0 +1,154 @@
+/**
+ * @file source.cpp
+ * @brief Zero-copy loading of source files.
+ */
+
+#include <wind/processing/source.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+/**
+ * @brief Constructor for an in-memory SourceBuffer.
+ * @param data The source text, a final newline is added if missing.
+ */
+SourceBuffer::SourceBuffer(std::string data) : owned(std::move(data)) {
+  if (!this->owned.empty() && this->owned.back() != '\n') {
+    this->owned.push_back('\n');
+  }
+  this->data = this->owned.data();
+  this->size = this->owned.size();
+  this->mapped = false;
+}
+
+/**
+ * @brief Destructor for SourceBuffer, unmaps the file.
+ */
+SourceBuffer::~SourceBuffer() {
+  if (this->mapped) {
+    munmap((void*)this->data, this->size);
+  }
+}
+
+/**
+ * @brief Maps a source file read-only.
+ * @param path The file to map.
+ * @return The buffer, or nullptr if the file can't be read or is too large
+ * for the 32-bit offsets of tokens and line starts.
+ */
+SourceBuffer *SourceBuffer::Map(const char *path) {
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return nullptr;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+    close(fd);
+    return nullptr;
+  }
+  size_t size = st.st_size;
+  // One more for a final newline, offsets go up to the size
+  if (size >= UINT32_MAX) {
+    close(fd);
+    std::cerr << "Source file too large, it must be under 4 GiB: " << path << std::endl;
+    return nullptr;
+  }
+  if (size == 0) {
+    close(fd);
+    return new SourceBuffer("");
+  }
+  void *addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    return nullptr;
+  }
+  madvise(addr, size, MADV_SEQUENTIAL);
+  const char *text = (const char*)addr;
+  if (text[size-1] != '\n') {
+    // The lexer needs a final newline, the mapping can't grow
+    SourceBuffer *copy = new SourceBuffer(std::string(text, size));
+    munmap(addr, size);
+    return copy;
+  }
+  return new SourceBuffer(text, size);
+}
+
+/**
+ * @brief Builds the line index of the buffer, once.
+ */
+void SourceBuffer::indexLines() {
+  if (!this->line_index.built()) {
+    this->line_index.build(this->view());
+  }
+}
+
+/**
+ * @brief Records the start of every line of a source.
+ * @param source The source text.
+ *
+ * Every newline opens a line, so the offset one past a final newline still
+ * maps to its own (empty) line, as with SourcePosition.
+ */
+void LineIndex::build(std::string_view source) {
+  this->source = source;
+  this->starts.clear();
+  this->starts.push_back(0);
+  const char *data = source.data();
+  size_t size = source.size();
+  const char *cursor = data;
+  while (const char *nl = (const char*)memchr(cursor, '\n', size - (cursor - data))) {
+    this->starts.push_back((uint32_t)(nl - data + 1));
+    cursor = nl + 1;
+  }
+}
+
+/**
+ * @brief Gets the line and column of an offset.
+ * @param offset The offset, at most the size of the source.
+ * @return The position, both from 1.
+ */
+TokenPos LineIndex::position(size_t offset) const {
+  auto it = std::upper_bound(this->starts.begin(), this->starts.end(), (uint32_t)offset);
+  uint32_t line = it - this->starts.begin();
+  return std::make_pair(line, (uint32_t)(offset - this->starts[line-1] + 1));
+}
+
+/**
+ * @brief Gets the text of a line, without its newline.
+ * @param line The line, from 1.
+ * @return The line, empty if out of the source.
+ */
+std::string_view LineIndex::line(uint32_t line) const {
+  if (line == 0 || line > this->starts.size()) {
+    return std::string_view();
+  }
+  size_t start = this->starts[line-1];
+  if (start >= this->source.size()) {
+    return std::string_view();
+  }
+  size_t end = line < this->starts.size() ? this->starts[line] - 1 : this->source.size();
+  return this->source.substr(start, end - start);
+}
+
+/**
+ * @brief Gets the line and column of an offset in a source.
+ * @param source The source text.
+ * @param offset The offset, at most the size of the source.
+ * @return The position, both from 1.
+ */
+TokenPos SourcePosition(std::string_view source, size_t offset) {
+  uint32_t line = 1;
+  size_t line_start = 0;
+  for (size_t i = 0; i < offset; i++) {
+    if (source[i] == '\n') {
+      line++;
+      line_start = i + 1;
+    }
+  }
+  return std::make_pair(line, (uint32_t)(offset - line_start + 1));
+}
@@ -4,6 +4,10 @@
 #include <filesystem>
 #include <unistd.h>
 
+#ifndef WIND_PKGS_PATH
+#define WIND_PKGS_PATH ""
+#endif
+
 bool LexUtils::whitespace(char c) {
   return (
     c == ' ' ||
@@ -44,7 +48,7 @@ std::string generateRandomFilePath(const std::string& directory, const std::stri
   return tempDir + "/" + randomFileName;
 }
 
-long long fmtinttostr(std::string &str) {
+long long fmtinttostr(const std::string &str) {
   if (str.size()>2 && str[0]=='0' && str[1]=='x') {
     return std::stoll(str.substr(2), nullptr, 16);
   }
@@ -56,13 +60,31 @@ std::string getRealPath(const std::string& path) {
   return std::filesystem::absolute(p).string();
 }
 
+// Resolved once per process, every std/pkgs include asks for it
 std::string getExeDir() {
-  char path[4096];
-  ssize_t count = readlink("/proc/self/exe", path, sizeof(path));
-  if (count == -1) {
-      perror("readlink");
-      return "";
+  static const std::string dir = []() -> std::string {
+    char path[4096];
+    ssize_t count = readlink("/proc/self/exe", path, sizeof(path) - 1);
+    if (count == -1) {
+        perror("readlink");
+        return "";
+    }
+    path[count] = '\0';
+    return std::filesystem::path(path).parent_path().string();
+  }();
+  return dir;
+}
+
+// "#name" lives under the packages path, anything else is relative to the
+// importing file
+std::string resolveImportPath(const std::string& relative, const std::string& from) {
+  if (relative[0] != '#') {
+    std::string folder = std::filesystem::path(from).parent_path().string();
+    return std::filesystem::path(folder).append(relative).string();
+  }
+  std::string path = std::filesystem::path(WIND_PKGS_PATH).append(relative.substr(1)).string();
+  if (path[0] != '/') {
+    path = std::filesystem::path(getExeDir()).append(path).string();
   }
-  path[count] = '\0';
-  return std::filesystem::path(path).parent_path().string();
+  return path;
 }
\ No newline at end of file
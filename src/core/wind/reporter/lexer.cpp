@@ -25,6 +25,6 @@ void LexerReport::handleErrors() {
     }
   }
   if (this->is_exiting) {
-    exit(1);
+    throw LexerFailure();
   }
 }
\ No newline at end of file
@@ -2,64 +2,62 @@
 #include <string>
 #include <vector>
 #include <iostream>
-#include <sstream>
 #include <iterator>
+#include <algorithm>
+#include <mutex>
 #include <wind/isc/isc.h>
 
-std::string ParserReport::line(uint16_t t_line) {
-    std::string line;
-    int i = 0;
-    while (std::getline(this->src, line)) {
-        i++;
-        if (i == t_line) {
-            ssize_t pos = 0;
-            while ((pos = line.find('\t', pos)) != (ssize_t)std::string::npos) {
-                line.replace(pos, 1, " ");
-                pos += 2;
-            }
-            return line;
-        }
-    }
-    return "";
+std::string ParserReport::line(uint32_t t_line) {
+    std::string line(this->lines.line(t_line));
+    // One column per byte, so the carets stay aligned
+    std::replace(line.begin(), line.end(), '\t', ' ');
+    return line;
 }
 
 #define LNUM_ADAPT_LEN 5
-void ReportLine(std::string line, TokenPos start, TokenPos end) {
-    std::string line_num = std::to_string(start.first);
-    line_num = std::string(LNUM_ADAPT_LEN - line_num.size(), ' ') + line_num;
+void ReportLine(uint32_t num, std::string line, uint32_t from, uint32_t to) {
+    std::string line_num = std::to_string(num);
+    if (line_num.size() < LNUM_ADAPT_LEN) {
+        line_num = std::string(LNUM_ADAPT_LEN - line_num.size(), ' ') + line_num;
+    }
     line_num = line_num + " | ";
     std::cerr << line_num << line << "\x1b[0m" << std::endl;
-    std::cerr << std::string(line_num.size()+start.second-1, ' ');
-    std::cerr << "\x1b[32m" << std::string(end.second-start.second, '^') << "\x1b[0m" << std::endl;
+    std::cerr << std::string(line_num.size()+from-1, ' ');
+    std::cerr << "\x1b[32m" << std::string(to > from ? to-from : 0, '^') << "\x1b[0m" << std::endl;
 }
 
-void ParserReport::Report(ParserReport::Type type, Token *expecting, Token *found) {
-    std::string path = global_isc->getPath(found->srcId);
+void ParserReport::Report(ParserReport::Type type, Token::Type expecting_type, std::string expecting, Token *found) {
+    // Function bodies may be parsed by several threads
+    static std::mutex report_mutex;
+    std::lock_guard<std::mutex> lock(report_mutex);
     if (type == ParserReport::Type::PARSER_WARNING) {
         std::cerr << "\x1b[33m[WARNING] \x1b[0m\x1b[1m" << "Unexpected token" << "\x1b[0m" << std::endl;
     } else if (type == ParserReport::Type::PARSER_ERROR) {
         std::cerr << "\x1b[31m[ERROR] \x1b[0m\x1b[1m" << "Unexpected token" << "\x1b[0m" << std::endl;
     }
 
-    if (!expecting || !found) {
+    if (!found) {
         return;
     }
+    std::string path = global_isc->getPath(found->srcId);
+    TokenRange range = found->range();
 
-    std::cerr << "\x1b[1m" << "Expecting: " << "\x1b[0m" << expecting->name;
-    if (expecting->type == Token::Type::SEMICOLON) {
+    std::cerr << "\x1b[1m" << "Expecting: " << "\x1b[0m" << expecting;
+    if (expecting_type == Token::Type::SEMICOLON) {
         std::cerr << " (Expression parsing)";
     }
     std::cerr << std::endl;
-    std::cerr << "\x1b[1m" << "Found: `" << "\x1b[0m" << found->name << "\x1b[0m`\x1b[36m (" 
-              << found->range.first.first << ":" << found->range.first.second << " to "
-              << found->range.second.first << ":" << found->range.second.second << ")\x1b[0m" 
+    std::cerr << "\x1b[1m" << "Found: `" << "\x1b[0m" << found->name() << "\x1b[0m`\x1b[36m (" 
+              << range.first.first << ":" << range.first.second << " to "
+              << range.second.first << ":" << range.second.second << ")\x1b[0m" 
               << " in \x1b[1m" << path << "\x1b[0m" << std::endl;
     
-    if (found->range.first.first != found->range.second.first) {
-        throw std::runtime_error("TODO: Multiline report");
+    for (uint32_t num = range.first.first; num <= range.second.first; num++) {
+        std::string text = this->line(num);
+        uint32_t from = num == range.first.first ? range.first.second : 1;
+        uint32_t to = num == range.second.first ? range.second.second : text.size() + 1;
+        ReportLine(num, text, from, to);
     }
-    
-    ReportLine(this->line(found->range.first.first), found->range.first, found->range.second);
 
     if (type == ParserReport::Type::PARSER_ERROR) {
         _Exit(1);
@@ -0,0 +1,403 @@
+/**
+ * @file server.cpp
+ * @brief Compile server and the client side forwarding to it.
+ *
+ * The server warms the interfaces under the std and pkgs paths, then forks
+ * a handler per connection. The handler takes the client's cwd, environment
+ * and stdio (passed with SCM_RIGHTS), forks the actual compile so that
+ * `_Exit` on errors still reports a status, and sends that status back.
+ * Forked compiles see the warm ASTs copy-on-write, the server never does.
+ */
+
+#include <wind/userface/server.h>
+#include <wind/userface/userf.h>
+#include <wind/processing/utils.h>
+#include <wind/isc/isc.h>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <cstring>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+#ifndef WIND_STD_PATH
+#define WIND_STD_PATH ""
+#endif
+#ifndef WIND_PKGS_PATH
+#define WIND_PKGS_PATH ""
+#endif
+
+extern char **environ;
+
+static std::string server_socket;
+
+/**
+ * @brief Gets the socket used when none is given: $WIND_SERVER, else
+ * windc.sock in $XDG_RUNTIME_DIR, else in a private /tmp/windc-<uid>.
+ * @return The socket, empty if /tmp/windc-<uid> exists but isn't a 0700
+ * directory of ours.
+ */
+std::string DefaultServerSocket() {
+  if (const char *env = std::getenv("WIND_SERVER")) {
+    return env;
+  }
+  const char *runtime = std::getenv("XDG_RUNTIME_DIR");
+  if (runtime && runtime[0] == '/') {
+    return std::string(runtime) + "/windc.sock";
+  }
+  std::string dir = "/tmp/windc-" + std::to_string(getuid());
+  mkdir(dir.c_str(), 0700);
+  struct stat st;
+  if (lstat(dir.c_str(), &st) != 0 || !S_ISDIR(st.st_mode) || st.st_uid != getuid() || (st.st_mode & 077) != 0) {
+    std::cerr << "Not using " << dir << " for the server socket, it must be a 0700 directory of ours\n";
+    return "";
+  }
+  return dir + "/windc.sock";
+}
+
+/**
+ * @brief Checks that the other end of a connection runs as our user.
+ */
+static bool peerIsUs(int fd) {
+  struct ucred cred;
+  socklen_t len = sizeof(cred);
+  return getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) == 0 && cred.uid == getuid();
+}
+
+/**
+ * @brief Reads or writes exactly `size` bytes.
+ */
+static bool transferAll(int fd, char *data, size_t size, bool writing) {
+  size_t done = 0;
+  while (done < size) {
+    ssize_t n = writing ? send(fd, data + done, size - done, MSG_NOSIGNAL) : read(fd, data + done, size - done);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    done += n;
+  }
+  return true;
+}
+
+/**
+ * @brief Connects to a server socket.
+ * @return The connected fd, -1 on failure.
+ */
+static int connectSocket(const std::string &path) {
+  struct sockaddr_un addr;
+  if (path.size() >= sizeof(addr.sun_path)) {
+    return -1;
+  }
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strcpy(addr.sun_path, path.c_str());
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    return -1;
+  }
+  if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+/**
+ * @brief Resolves a std/pkgs directory the way the parser does.
+ */
+static std::string resolveDataPath(std::string path) {
+  if (!path.empty() && path[0] != '/') {
+    path = std::filesystem::path(getExeDir()).append(path).string();
+  }
+  return path;
+}
+
+/**
+ * @brief Warms an interface if it parses cleanly.
+ *
+ * The trial parse runs in a child first: a broken package interface would
+ * otherwise take the server down with it.
+ */
+static void warmIfValid(const std::string &path) {
+  pid_t pid = fork();
+  if (pid == 0) {
+    int null_fd = open("/dev/null", O_WRONLY);
+    dup2(null_fd, STDERR_FILENO);
+    _Exit(WarmInterface(path) ? 0 : 1);
+  }
+  int status = 0;
+  if (pid < 0 || waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    std::cerr << "Not warming " << path << "\n";
+    return;
+  }
+  WarmInterface(path);
+}
+
+/**
+ * @brief Warms the std interfaces and the interface of every package.
+ */
+static void warmInterfaces() {
+  std::error_code ec;
+  std::string std_path = resolveDataPath(WIND_STD_PATH);
+  for (auto &entry : std::filesystem::directory_iterator(std_path, ec)) {
+    if (entry.path().extension() == ".wi") {
+      warmIfValid(entry.path().string());
+    }
+  }
+  std::string pkgs_path = resolveDataPath(WIND_PKGS_PATH);
+  for (auto &entry : std::filesystem::directory_iterator(pkgs_path, ec)) {
+    std::filesystem::path wi = entry.path() / (entry.path().filename().string() + ".wi");
+    if (entry.is_directory(ec) && std::filesystem::exists(wi, ec)) {
+      warmIfValid(wi.string());
+    }
+  }
+}
+
+/**
+ * @brief Appends a NUL terminated field to a request.
+ */
+static void putField(std::string &out, const std::string &field) {
+  out += field;
+  out += '\0';
+}
+
+/**
+ * @brief Forwards a command line to a running server.
+ * @param socket_path The server socket.
+ * @param argc Number of command-line arguments.
+ * @param argv Array of command-line arguments.
+ * @param status Set to the exit status of the remote compile.
+ * @return False if no server answered, the caller then compiles locally.
+ *
+ * Request: a 4 byte length carrying our stdin/stdout/stderr, then the cwd,
+ * the arguments and the environment as counted NUL terminated fields.
+ */
+bool ForwardToServer(std::string socket_path, int argc, char **argv, int &status) {
+  int fd = connectSocket(socket_path);
+  if (fd < 0) {
+    return false;
+  }
+  if (!peerIsUs(fd)) {
+    // Our stdio and environment are only handed to our own server
+    close(fd);
+    std::cerr << "Ignoring the compile server on " << socket_path << ", it runs as another user\n";
+    return false;
+  }
+  std::error_code ec;
+  std::string request;
+  putField(request, std::filesystem::current_path(ec).string());
+  putField(request, std::to_string(argc));
+  for (int i = 0; i < argc; i++) {
+    putField(request, argv[i]);
+  }
+  size_t envc = 0;
+  while (environ[envc]) envc++;
+  putField(request, std::to_string(envc));
+  for (size_t i = 0; i < envc; i++) {
+    putField(request, environ[i]);
+  }
+
+  uint32_t size = request.size();
+  int fds[3] = {STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO};
+  char control[CMSG_SPACE(sizeof(fds))];
+  memset(control, 0, sizeof(control));
+  struct iovec iov = {&size, sizeof(size)};
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+  struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+  memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+  int32_t remote = 0;
+  bool ok = sendmsg(fd, &msg, MSG_NOSIGNAL) == sizeof(size) &&
+            transferAll(fd, &request[0], request.size(), true) &&
+            transferAll(fd, (char*)&remote, sizeof(remote), false);
+  close(fd);
+  if (!ok) {
+    // The request may have been half served, don't compile twice
+    std::cerr << "Lost connection to the compile server\n";
+    remote = 1;
+  }
+  status = remote;
+  return true;
+}
+
+/**
+ * @brief Serves a single connection, runs in its own process.
+ * @param conn The connection fd.
+ */
+static void serveConnection(int conn) {
+  uint32_t size = 0;
+  int fds[3] = {-1, -1, -1};
+  char control[CMSG_SPACE(sizeof(fds))];
+  struct iovec iov = {&size, sizeof(size)};
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+  if (recvmsg(conn, &msg, MSG_CMSG_CLOEXEC) != sizeof(size)) {
+    return;
+  }
+  struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+  if (!cmsg || cmsg->cmsg_type != SCM_RIGHTS || cmsg->cmsg_len != CMSG_LEN(sizeof(fds))) {
+    return;
+  }
+  memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+  std::string request(size, '\0');
+  if (size > (1 << 24) || !transferAll(conn, &request[0], size, false)) {
+    return;
+  }
+
+  std::vector<std::string> fields;
+  for (size_t start = 0; start < request.size();) {
+    size_t end = request.find('\0', start);
+    if (end == std::string::npos) return;
+    fields.push_back(request.substr(start, end - start));
+    start = end + 1;
+  }
+  size_t at = 0;
+  auto next = [&]() -> std::string { return at < fields.size() ? fields[at++] : ""; };
+  std::string cwd = next();
+  int argc = std::atoi(next().c_str());
+  std::vector<std::string> args;
+  for (int i = 0; i < argc; i++) {
+    args.push_back(next());
+  }
+  size_t envc = std::atoll(next().c_str());
+  std::vector<std::string> env;
+  for (size_t i = 0; i < envc; i++) {
+    env.push_back(next());
+  }
+  if (at != fields.size() || argc < 1) {
+    return;
+  }
+
+  int32_t status = 1;
+  pid_t pid = fork();
+  if (pid == 0) {
+    close(conn);
+    for (int i = 0; i < 3; i++) {
+      dup2(fds[i], i);
+    }
+    if (chdir(cwd.c_str()) != 0) {
+      std::cerr << "Cannot enter " << cwd << "\n";
+      _Exit(1);
+    }
+    clearenv();
+    for (std::string &var : env) {
+      putenv(strdup(var.c_str()));
+    }
+    std::vector<char*> argv;
+    for (std::string &arg : args) {
+      argv.push_back(strdup(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+    InitISC();
+    WindUserInterface *ui = new WindUserInterface(argc, argv.data());
+    ui->processFiles();
+    delete ui;
+    fflush(nullptr);
+    _Exit(0);
+  }
+  int wstatus = 0;
+  if (pid > 0 && waitpid(pid, &wstatus, 0) == pid) {
+    status = WIFEXITED(wstatus) ? WEXITSTATUS(wstatus) : 128 + WTERMSIG(wstatus);
+  }
+  transferAll(conn, (char*)&status, sizeof(status), true);
+}
+
+/**
+ * @brief Removes the socket when the server is stopped.
+ */
+static void stopServer(int) {
+  unlink(server_socket.c_str());
+  _exit(0);
+}
+
+/**
+ * @brief Runs the compile server until it is killed.
+ * @param socket_path The socket to listen on.
+ * @return Exit status, only returned on setup errors.
+ */
+int RunServer(std::string socket_path) {
+  if (socket_path.empty()) {
+    return 1;
+  }
+  server_socket = socket_path;
+  struct sockaddr_un addr;
+  if (socket_path.size() >= sizeof(addr.sun_path)) {
+    std::cerr << "Socket path too long: " << socket_path << "\n";
+    return 1;
+  }
+  int probe = connectSocket(socket_path);
+  if (probe >= 0) {
+    close(probe);
+    std::cerr << "A server is already listening on " << socket_path << "\n";
+    return 1;
+  }
+  unlink(socket_path.c_str());
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strcpy(addr.sun_path, socket_path.c_str());
+  int listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  // Only we may connect, connections are checked again on accept
+  mode_t mask = umask(077);
+  bool bound = listen_fd >= 0 && bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) == 0;
+  umask(mask);
+  if (!bound || listen(listen_fd, 128) != 0) {
+    std::cerr << "Cannot listen on " << socket_path << ": " << strerror(errno) << "\n";
+    return 1;
+  }
+
+  InitISC();
+  warmInterfaces();
+
+  signal(SIGINT, stopServer);
+  signal(SIGTERM, stopServer);
+  signal(SIGPIPE, SIG_IGN);
+  // Handlers are never waited for
+  signal(SIGCHLD, SIG_IGN);
+  std::cerr << "windc server listening on " << socket_path << "\n";
+
+  while (true) {
+    int conn = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+    if (conn < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) continue;
+      std::cerr << "accept: " << strerror(errno) << "\n";
+      break;
+    }
+    if (!peerIsUs(conn)) {
+      close(conn);
+      continue;
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+      close(listen_fd);
+      signal(SIGCHLD, SIG_DFL);
+      signal(SIGINT, SIG_DFL);
+      signal(SIGTERM, SIG_DFL);
+      signal(SIGPIPE, SIG_DFL);
+      serveConnection(conn);
+      _Exit(0);
+    }
+    close(conn);
+  }
+  unlink(socket_path.c_str());
+  return 1;
+}
@@ -8,6 +8,7 @@
 #include <wind/processing/lexer.h>
 #include <wind/processing/parser.h>
 #include <wind/bridge/ast.h>
+#include <wind/bridge/arena.h>
 #include <wind/bridge/ast_printer.h>
 #include <wind/generation/compiler.h>
 #include <wind/generation/optimizer.h>
@@ -16,9 +17,21 @@
 #include <wind/isc/isc.h>
 #include <wind/backend/x86_64/backend.h>
 #include <wind/backend/interface/ld.h>
+#include <wind/backend/jit/jit.h>
+#include <wind/backend/writer/format/elf.h>
+#include <wind/common/timing.h>
+#include <wind/common/memory.h>
+#include <wind/reporter/lexer.h>
 
 #include <filesystem>
 #include <iostream>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#include <spawn.h>
+#include <sys/wait.h>
 
 #ifndef WIND_RUNTIME_PATH
 #warning "WIND_RUNTIME_PATH not defined"
@@ -29,6 +42,15 @@ const char HELP[] = "Usage: wind [options] [files]\n"
                     "Options:\n"
                     "  -ej  Emit object file\n"
                     "  -o   Output file path\n"
+                    "  -j   Number of files compiled in parallel, spare jobs parse function bodies (0: one per core)\n"
+                    "  -fcache  Reuse objects and precompiled interfaces from the cache ($WIND_CACHE_DIR)\n"
+                    "  -fno-integrated-as  Assemble with the system as\n"
+                    "  -fprebuilt  Link <pkg>/<pkg>.o instead of compiling an up to date package\n"
+                    "  --run <file> [args]  Compile in memory and run the program\n"
+                    "  --server [socket]  Serve compiles, used when $WIND_SERVER is set\n"
+                    "  -ftime-report  Print wall and CPU time per phase and per file\n"
+                    "  --trace-json <path>  Write a Chrome trace of the compile phases\n"
+                    "  -fmem-report  Print allocations per phase and peak RSS\n"
                     "  -sa  Show AST\n"
                     "  -si  Show IR\n"
                     "  -ss"
@@ -41,10 +63,24 @@ const char HELP[] = "Usage: wind [options] [files]\n"
  */
 WindUserInterface::WindUserInterface(int argc, char **argv) {
   this->flags = 0;
+  this->jobs = 1;
+  this->parse_jobs = 1;
+  this->cache = nullptr;
+  this->argc = argc;
   this->argv = argv;
   for (int i = 1; i < argc; i++) {
     parseArgument(std::string(argv[i]), i);
   }
+  if (this->flags & TIME_REPORT || this->trace_path != "") {
+    EnableTimeTrace();
+  }
+  if (this->flags & MEM_REPORT) {
+    EnableMemoryReport();
+  }
+  if (this->flags & USE_CACHE && !(this->flags & SHOW_ANY)) {
+    this->cache = new WindObjectCache(WindObjectCache::defaultDir());
+    UseInterfaceImages(this->cache);
+  }
 }
 
 /**
@@ -54,6 +90,41 @@ WindUserInterface::~WindUserInterface() {
   for (std::string obj : this->objects) {
     std::filesystem::remove(obj);
   }
+  if (this->cache) {
+    UseInterfaceImages(nullptr);
+  }
+  delete this->cache;
+  this->reportTiming();
+}
+
+/**
+ * @brief Prints the time and memory reports and writes the trace, when
+ * requested.
+ */
+void WindUserInterface::reportTiming() {
+  if (this->flags & TIME_REPORT) {
+    PrintTimeReport(std::cerr);
+  }
+  if (this->flags & MEM_REPORT) {
+    PrintMemoryReport(std::cerr);
+  }
+  if (this->trace_path != "" && !WriteTimeTrace(this->trace_path)) {
+    std::cerr << "Cannot write trace to " << this->trace_path << std::endl;
+  }
+}
+
+/**
+ * @brief Takes the value following an option.
+ * @param arg The option.
+ * @param i The index of the option, moved to the value.
+ * @return The value, the process exits if it is missing.
+ */
+std::string WindUserInterface::takeValue(const std::string &arg, int &i) {
+  if (i + 1 >= this->argc) {
+    std::cerr << "Missing value for " << arg << "\n";
+    _Exit(1);
+  }
+  return std::string(this->argv[++i]);
 }
 
 /**
@@ -66,7 +137,17 @@ void WindUserInterface::parseArgument(std::string arg, int &i) {
     this->flags |= EMIT_OBJECT;
   }
   else if (arg == "-o") {
-    this->output = std::string(argv[++i]);
+    this->output = this->takeValue(arg, i);
+  }
+  else if (arg == "-j") {
+    std::string value = this->takeValue(arg, i);
+    char *end = nullptr;
+    long n = std::strtol(value.c_str(), &end, 10);
+    if (value.empty() || *end != '\0' || n < 0 || n > 4096) {
+      std::cerr << "Invalid job count: " << value << "\n";
+      _Exit(1);
+    }
+    this->jobs = n > 0 ? n : std::max(1u, std::thread::hardware_concurrency());
   }
   else if (arg == "-sa") {
     this->flags |= SHOW_AST;
@@ -80,6 +161,35 @@ void WindUserInterface::parseArgument(std::string arg, int &i) {
   else if (arg == "-ss") {
     this->flags |= SHOW_ASM;
   }
+  else if (arg == "-fcache") {
+    this->flags |= USE_CACHE;
+  }
+  else if (arg == "-fprebuilt") {
+    this->flags |= USE_PREBUILT;
+  }
+  else if (arg == "-fno-integrated-as") {
+    this->flags |= EXTERNAL_AS;
+  }
+  else if (arg == "-ftime-report") {
+    this->flags |= TIME_REPORT;
+  }
+  else if (arg == "-fmem-report") {
+    this->flags |= MEM_REPORT;
+  }
+  else if (arg == "--trace-json") {
+    this->trace_path = this->takeValue(arg, i);
+  }
+  else if (arg == "--run") {
+    this->flags |= JIT_RUN;
+    // The file to run comes next, everything after it belongs to the program
+    if (i + 1 < this->argc) {
+      files.push_back(std::string(argv[++i]));
+      this->run_args.push_back(files.back());
+      while (i + 1 < this->argc) {
+        this->run_args.push_back(std::string(argv[++i]));
+      }
+    }
+  }
   else if (arg == "-h") {
     std::cout << HELP;
     _Exit(0);
@@ -92,15 +202,49 @@ void WindUserInterface::parseArgument(std::string arg, int &i) {
 /**
  * @brief Emits an object file from the given path.
  * @param path The path to the source file.
+ * @param unit The compile unit collecting the produced objects and link flags.
  */
-void WindUserInterface::emitObject(std::string path) {
+void WindUserInterface::emitObject(std::string path, CompileUnit &unit) {
   global_isc->tabulaRasa();
-  WindLexer *lexer = TokenizeFile(path.c_str());
+  std::string outpath = "";
+  if (this->flags & EMIT_OBJECT && this->files.size()==1 && this->output != "" && path == this->files[0]) {
+    outpath = this->output;
+  }
+
+  std::string cache_key = "";
+  if (this->cache) {
+    WindTimer timer("cache", path);
+    cache_key = this->cache->key(path, this->flags & ~NO_EMISSION_FLAGS);
+    CacheEntry hit;
+    // A failed copy (entry removed by another windc, unwritable output)
+    // falls back to compiling the file
+    std::string hit_path = outpath != "" ? outpath : generateRandomFilePath("", ".o");
+    std::error_code ec;
+    if (
+      this->cache->lookup(cache_key, hit) &&
+      std::filesystem::copy_file(hit.object, hit_path, std::filesystem::copy_options::overwrite_existing, ec)
+    ) {
+      unit.objects.push_back(hit_path);
+      for (std::string flag : hit.ld_flags) {
+        unit.ld_flags.push_back(flag);
+      }
+      for (std::string src : hit.imports) {
+        unit.imports.push_back(src);
+      }
+      return;
+    }
+  }
+
+  // The AST of the unit, included interfaces too, goes away with it
+  ASTArena arena;
+  ASTArena::Scope arena_scope(&arena);
+  WindLexer *lexer = StreamFile(path.c_str());
   if (lexer == nullptr) {
     std::cerr << "File not found: " << path << std::endl;
     _Exit(1);
   }
   WindParser *parser = new WindParser(lexer->get(), path);
+  parser->setJobs(this->parse_jobs);
   Body *ast = parser->parse();
   if (flags & SHOW_AST) {
     std::cout << "[" << path << "] AST:" << std::endl;
@@ -109,7 +253,11 @@ void WindUserInterface::emitObject(std::string path) {
     std::cout << "\n\n";
   }
 
-  WindCompiler *ir = new WindCompiler(ast);
+  WindCompiler *ir;
+  {
+    WindTimer timer("compile", path);
+    ir = new WindCompiler(ast);
+  }
 
   if (flags & SHOW_RAW_IR) {
     std::cout << "[" << path << "] RAW IR:" << std::endl;
@@ -118,7 +266,11 @@ void WindUserInterface::emitObject(std::string path) {
     std::cout << "\n\n";
   }
 
-  WindOptimizer *opt = new WindOptimizer(ir->get());
+  WindOptimizer *opt;
+  {
+    WindTimer timer("optimize", path);
+    opt = new WindOptimizer(ir->get());
+  }
   IRBody *optimized = opt->get();
 
   if (flags & SHOW_IR) {
@@ -128,29 +280,40 @@ void WindUserInterface::emitObject(std::string path) {
     std::cout << "\n\n";
   }
 
-  WindEmitter *backend = new WindEmitter(optimized);
-  backend->Process();
+  WindEmitter *backend = new WindEmitter(optimized, !(this->flags & (SHOW_ASM | EXTERNAL_AS)));
+  {
+    WindTimer timer("emit", path);
+    backend->Process();
+  }
   std::string output = "";
-  if (this->flags & EMIT_OBJECT && this->files.size()==1 && this->output != "") {
-    output = backend->emitObj(this->output);
-  } else {
-    output = backend->emitObj();
+  ObjectImage image;
+  {
+    WindTimer timer("assemble", path);
+    if (this->flags & JIT_RUN && backend->emitImage(image)) {
+      unit.images.push_back(image);
+    } else {
+      output = backend->emitObj(outpath);
+      unit.objects.push_back(output);
+    }
   }
   if (this->flags & SHOW_ASM) {
     std::cout << "[" << path << "] ASM:" << std::endl;
     std::cout << backend->GetAsm() << std::endl;
   }
-  this->objects.push_back(output);
 
   std::vector<std::string> user_ld_flags = global_isc->getLdFlags();
   for (std::string flag : user_ld_flags) {
-    this->user_ld_flags.push_back(flag);
+    unit.ld_flags.push_back(flag);
   }
 
-  std::vector<std::string> pending_src = global_isc->getImports();
+  std::vector<std::string> pending_src = global_isc->takeImports();
+  if (this->cache && output != "") {
+    std::vector<std::string> deps = global_isc->getPaths();
+    deps.erase(std::remove(deps.begin(), deps.end(), getRealPath(path)), deps.end());
+    this->cache->store(cache_key, output, deps, user_ld_flags, pending_src);
+  }
   for (std::string src : pending_src) {
-    global_isc->popImport();
-    this->emitObject(src);
+    unit.imports.push_back(src);
   }
   
   delete ir;
@@ -158,6 +321,79 @@ void WindUserInterface::emitObject(std::string path) {
   delete backend;
 }
 
+/**
+ * @brief Gets the path identifying a source, however it was spelled.
+ */
+static std::string canonicalSource(const std::string &path) {
+  std::error_code ec;
+  std::string canonical = std::filesystem::weakly_canonical(path, ec).string();
+  return ec ? getRealPath(path) : canonical;
+}
+
+/**
+ * @brief Claims a source for this invocation.
+ * @param path The source path.
+ * @return False if another unit (or an input file) already compiles it.
+ */
+bool WindUserInterface::claimSource(std::string path) {
+  std::lock_guard<std::mutex> lock(this->claimed_mutex);
+  return this->claimed_sources.insert(canonicalSource(path)).second;
+}
+
+/**
+ * @brief Lists the package sources a source imports, without parsing it.
+ * @param path The source path.
+ */
+static std::vector<std::string> scanImports(const std::string &path) {
+  std::vector<std::string> imports;
+  WindLexer *lexer = TokenizeFile(path.c_str());
+  if (lexer == nullptr) {
+    return imports;
+  }
+  const std::vector<Token> &tokens = lexer->get()->getVec();
+  for (size_t i = 0; i + 2 < tokens.size(); i++) {
+    if (tokens[i].type != Token::Type::AT || tokens[i+1].type != Token::Type::IDENTIFIER ||
+        tokens[i+1].symbol != KW_IMPORT) {
+      continue;
+    }
+    bool list = tokens[i+2].type == Token::Type::LBRACKET;
+    for (size_t j = i + 2 + list; j < tokens.size() && tokens[j].type == Token::Type::STRING; j++) {
+      std::string dir = resolveImportPath(tokens[j].value(), path);
+      std::string name = std::filesystem::path(dir).filename().string();
+      imports.push_back(dir + "/" + name + ".w");
+      if (!list) break;
+    }
+  }
+  return imports;
+}
+
+/**
+ * @brief Emits the object of an imported package source.
+ * @param path The package source (`<pkg>/<pkg>.w`).
+ * @param unit The compile unit of the package.
+ *
+ * With -fprebuilt, a `<pkg>/<pkg>.o` newer than the package source and
+ * interface is linked instead (build it with `windc <pkg>.w -ej -o <pkg>.o`).
+ * It holds the package alone: the packages it imports are found by lexing
+ * its source.
+ */
+void WindUserInterface::emitImport(std::string path, CompileUnit &unit) {
+  if (this->flags & USE_PREBUILT) {
+    std::filesystem::path src(path);
+    std::filesystem::path object = std::filesystem::path(src).replace_extension(".o");
+    std::filesystem::path interface = std::filesystem::path(src).replace_extension(".wi");
+    std::error_code ec, src_ec, wi_ec;
+    auto object_time = std::filesystem::last_write_time(object, ec);
+    if (!ec && object_time >= std::filesystem::last_write_time(src, src_ec) &&
+        object_time >= std::filesystem::last_write_time(interface, wi_ec) && !src_ec && !wi_ec) {
+      unit.prebuilt.push_back(object.string());
+      unit.imports = scanImports(path);
+      return;
+    }
+  }
+  this->emitObject(path, unit);
+}
+
 void WindUserInterface::ldDefFlags(WindLdInterface *ld) {
   ld->addFlag("-m elf_x86_64");
   for (std::string flag : this->user_ld_flags) {
@@ -165,15 +401,228 @@ void WindUserInterface::ldDefFlags(WindLdInterface *ld) {
   }
 }
 
-void WindUserInterface::ldExecFlags(WindLdInterface *ld) {
-  ld->addFlag("-dynamic-linker /lib64/ld-linux-x86-64.so.2");
-  ld->addFlag("-lc");
+/**
+ * @brief Gets the path of the prebuilt runtime object (wrt.o).
+ */
+static std::string runtimeObject() {
   std::string path = std::string(WIND_RUNTIME_PATH);
   if (path[0] != '/') {
     path = std::filesystem::path(getExeDir()).append(path).string();
   }
-  std::string runtime_lib = path + "/wrt.o";
-  ld->addFile(runtime_lib);
+  return path + "/wrt.o";
+}
+
+void WindUserInterface::ldExecFlags(WindLdInterface *ld) {
+  ld->addFlag("-dynamic-linker /lib64/ld-linux-x86-64.so.2");
+  ld->addFlag("-lc");
+  ld->addFile(runtimeObject());
+}
+
+/**
+ * @brief Runs the compiled program (--run).
+ * @param units The compiled units, in input order.
+ * @return The exit status of the program.
+ *
+ * Units and the runtime are loaded into memory and main is called directly.
+ * If they can't be loaded in-process (e.g. a library that is only available
+ * as a static archive), the program is linked as usual and executed instead.
+ */
+int WindUserInterface::runProgram(std::vector<CompileUnit> &units) {
+  WindJit *jit = new WindJit();
+  bool loaded = jit->addObject(runtimeObject());
+  for (CompileUnit &unit : units) {
+    for (ObjectImage &image : unit.images) {
+      jit->addImage(image);
+    }
+  }
+  for (size_t i = 0; loaded && i < this->objects.size(); i++) {
+    loaded = jit->addObject(this->objects[i]);
+  }
+  for (size_t i = 0; loaded && i < this->prebuilt.size(); i++) {
+    loaded = jit->addObject(this->prebuilt[i]);
+  }
+  for (std::string flag : this->user_ld_flags) {
+    jit->addLdFlag(flag);
+  }
+  std::vector<char*> args;
+  for (std::string &arg : this->run_args) {
+    args.push_back((char*)arg.c_str());
+  }
+  args.push_back(nullptr);
+  if (loaded && jit->link()) {
+    WindTimer timer("run");
+    int ret = jit->run(args.size() - 1, args.data());
+    delete jit;
+    return ret;
+  }
+  std::cerr << "Cannot run in memory (" << jit->getError() << "), linking instead\n";
+  delete jit;
+
+  for (CompileUnit &unit : units) {
+    for (ObjectImage &image : unit.images) {
+      std::string path = generateRandomFilePath("", ".o");
+      if (!WindElfWriter(image).Write(path)) {
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+        std::cerr << "Cannot write object " << path << "\n";
+        return 1;
+      }
+      this->objects.push_back(path);
+    }
+  }
+  WindLdInterface *ld = new WindLdInterface();
+  ldDefFlags(ld);
+  ldExecFlags(ld);
+  for (std::string obj : this->objects) {
+    ld->addFile(obj);
+  }
+  for (std::string obj : this->prebuilt) {
+    ld->addFile(obj);
+  }
+  std::string exe = ld->link();
+  delete ld;
+  pid_t pid;
+  int status = 0;
+  {
+    WindTimer timer("run");
+    if (posix_spawn(&pid, exe.c_str(), nullptr, nullptr, args.data(), environ) != 0 ||
+        waitpid(pid, &status, 0) < 0) {
+      std::cerr << "Cannot execute " << exe << "\n";
+      status = 1 << 8;
+    }
+  }
+  std::filesystem::remove(exe);
+  return WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+}
+
+/**
+ * @brief Compiles sources into their own compile units, in parallel.
+ * @param paths The sources.
+ * @param units One unit per source, filled in order.
+ * @param packages True for imported package sources.
+ *
+ * With more than one job each worker thread gets its own ISC context, so
+ * files never share lexer/parser/compiler state. Dumps (-sa, -si, -ss) keep
+ * the sequential path so their output is not interleaved.
+ */
+void WindUserInterface::runUnits(const std::vector<std::string> &paths, std::vector<CompileUnit> &units, bool packages) {
+  unsigned workers = std::min<size_t>(this->jobs, paths.size());
+  // Jobs left over by the files parse function bodies
+  this->parse_jobs = std::max<unsigned>(1, this->jobs / std::max<unsigned>(1, workers));
+  if (workers <= 1 || this->flags & SHOW_ANY) {
+    this->parse_jobs = this->jobs;
+    try {
+      for (size_t i = 0; i < paths.size(); i++) {
+        if (packages) {
+          this->emitImport(paths[i], units[i]);
+        } else {
+          this->emitObject(paths[i], units[i]);
+        }
+      }
+    } catch (const LexerFailure &) {
+      exit(1);
+    }
+    return;
+  }
+  std::atomic<size_t> next(0);
+  std::vector<std::thread> pool;
+  // The first error of a worker, raised again once every worker is joined
+  std::exception_ptr error;
+  std::mutex error_mutex;
+  for (unsigned w = 0; w < workers; w++) {
+    pool.emplace_back([this, &paths, &units, packages, &next, &error, &error_mutex]() {
+      InitISC();
+      try {
+        for (size_t i = next++; i < paths.size(); i = next++) {
+          if (packages) {
+            this->emitImport(paths[i], units[i]);
+          } else {
+            this->emitObject(paths[i], units[i]);
+          }
+        }
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error) {
+          error = std::current_exception();
+        }
+        next = paths.size();
+      }
+    });
+  }
+  for (std::thread &worker : pool) {
+    worker.join();
+  }
+  if (error) {
+    try {
+      std::rethrow_exception(error);
+    } catch (const LexerFailure &) {
+      exit(1);
+    }
+  }
+}
+
+/**
+ * @brief Claims the packages imported by units that nothing compiles yet.
+ * @param units The units, in order.
+ * @return The claimed package sources, in import order.
+ */
+std::vector<std::string> WindUserInterface::claimImports(const std::vector<CompileUnit> &units) {
+  std::vector<std::string> claimed;
+  for (const CompileUnit &unit : units) {
+    for (const std::string &src : unit.imports) {
+      if (this->claimSource(src)) {
+        claimed.push_back(src);
+      }
+    }
+  }
+  return claimed;
+}
+
+/**
+ * @brief Appends a unit, then the packages it is the first to import.
+ * @param unit The unit, moved out.
+ * @param packages The compiled packages, by canonical source.
+ * @param units The units in link order.
+ */
+static void placeUnit(CompileUnit &unit, std::map<std::string, CompileUnit> &packages, std::vector<CompileUnit> &units) {
+  std::vector<std::string> imports = unit.imports;
+  units.push_back(std::move(unit));
+  for (const std::string &src : imports) {
+    auto it = packages.find(canonicalSource(src));
+    if (it != packages.end()) {
+      CompileUnit package = std::move(it->second);
+      packages.erase(it);
+      placeUnit(package, packages, units);
+    }
+  }
+}
+
+/**
+ * @brief Compiles the input files, then the packages they import.
+ * @param units Filled in link order.
+ *
+ * Packages are compiled once per invocation however many files import them,
+ * in waves once their importers are done. Each then follows the first unit
+ * importing it, as if the files and packages were compiled one by one in
+ * input order, so the link line does not depend on scheduling.
+ */
+void WindUserInterface::compileUnits(std::vector<CompileUnit> &units) {
+  std::vector<CompileUnit> inputs(this->files.size());
+  this->runUnits(this->files, inputs, false);
+  std::map<std::string, CompileUnit> packages;
+  std::vector<std::string> wave = this->claimImports(inputs);
+  while (!wave.empty()) {
+    std::vector<CompileUnit> done(wave.size());
+    this->runUnits(wave, done, true);
+    std::vector<std::string> next = this->claimImports(done);
+    for (size_t i = 0; i < wave.size(); i++) {
+      packages[canonicalSource(wave[i])] = std::move(done[i]);
+    }
+    wave = next;
+  }
+  for (CompileUnit &unit : inputs) {
+    placeUnit(unit, packages, units);
+  }
 }
 
 /**
@@ -185,14 +634,41 @@ void WindUserInterface::processFiles() {
     std::cerr << "No input file provided\n";
     _Exit(1);
   }
-  for (std::string file : files) {
-    this->emitObject(file);
+  for (std::string file : this->files) {
+    this->claimSource(file);
+  }
+  std::vector<CompileUnit> units;
+  this->compileUnits(units);
+  // Merge in input order so the link line does not depend on scheduling
+  for (CompileUnit &unit : units) {
+    for (std::string obj : unit.objects) {
+      this->objects.push_back(obj);
+    }
+    for (std::string obj : unit.prebuilt) {
+      this->prebuilt.push_back(obj);
+    }
+    for (std::string flag : unit.ld_flags) {
+      if (std::find(this->user_ld_flags.begin(), this->user_ld_flags.end(), flag) == this->user_ld_flags.end()) {
+        this->user_ld_flags.push_back(flag);
+      }
+    }
+  }
+
+  if (this->flags & JIT_RUN) {
+    int ret = this->runProgram(units);
+    for (std::string obj : this->objects) {
+      std::filesystem::remove(obj);
+    }
+    this->reportTiming();
+    _Exit(ret);
   }
 
   WindLdInterface *ld = new WindLdInterface(this->output);
   ldDefFlags(ld);
   if (this->flags & EMIT_OBJECT) {
     if (this->files.size()==1 && this->output != "") {
+      // The object was emitted straight to the output, keep it
+      this->objects.erase(std::remove(this->objects.begin(), this->objects.end(), this->output), this->objects.end());
       delete ld;
       return;
     }
@@ -203,6 +679,9 @@ void WindUserInterface::processFiles() {
   for (std::string obj : this->objects) {
     ld->addFile(obj);
   }
+  for (std::string obj : this->prebuilt) {
+    ld->addFile(obj);
+  }
   std::string outtmp = ld->link();
   for (std::string obj : this->objects) {
     std::filesystem::remove(obj);
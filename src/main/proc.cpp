@@ -4,6 +4,7 @@
  */
 
 #include <wind/userface/userf.h>
+#include <wind/userface/server.h>
 #include <wind/isc/isc.h>
 
 #include <iostream>
@@ -20,6 +21,15 @@
  * @return Exit status.
  */
 int main(int argc, char **argv) {
+  if (argc > 1 && std::string(argv[1]) == "--server") {
+    return RunServer(argc > 2 ? argv[2] : DefaultServerSocket());
+  }
+  if (const char *server = std::getenv("WIND_SERVER")) {
+    int status = 0;
+    if (ForwardToServer(server, argc, argv, status)) {
+      return status;
+    }
+  }
   InitISC();
   WindUserInterface *ui = new WindUserInterface(argc, argv);
   ui->processFiles();
@@ -19,11 +19,14 @@ int litId=0;
 
 WindLexer *TokenizeLiteral(std::string data) {
   data.push_back('\n');
-  WindLexer *lex = new WindLexer(data.c_str());
+  SourceBuffer *source = new SourceBuffer(data);
+  source->indexLines();
+  WindLexer *lex = new WindLexer(source->view());
   lex->tokenize();
   global_isc->setPath(lex->srcId, "literal"+std::to_string(litId++));
+  global_isc->setSource(lex->srcId, source);
   global_isc->setStream(lex->srcId, lex->get());
-  global_isc->newParserReport(lex->srcId, data);
+  global_isc->newParserReport(lex->srcId, source);
   return lex;
 }
 
@@ -45,7 +48,7 @@ PYBIND11_MODULE(libpyapi, module) {
   module.doc() = "Wind Compiler python API";
 
   py::class_<TokenPos>(module, "TokenPos")
-    .def(py::init<u_int16_t, u_int16_t>());
+    .def(py::init<uint32_t, uint32_t>());
 
   py::enum_<Token::Type>(module, "TokenType")
     .value("IDENTIFIER", Token::Type::IDENTIFIER)
@@ -54,6 +57,7 @@ PYBIND11_MODULE(libpyapi, module) {
     .value("MINUS", Token::Type::MINUS)
     .value("MULTIPLY", Token::Type::MULTIPLY)
     .value("DIVIDE", Token::Type::DIVIDE)
+    .value("MODULO", Token::Type::MODULO)
     .value("ASSIGN", Token::Type::ASSIGN)
     .value("LPAREN", Token::Type::LPAREN)
     .value("RPAREN", Token::Type::RPAREN)
@@ -69,23 +73,63 @@ PYBIND11_MODULE(libpyapi, module) {
     .value("STRING", Token::Type::STRING)
     .value("VARDC", Token::Type::VARDC)
     .value("AND", Token::Type::AND)
+    .value("OR", Token::Type::OR)
+    .value("XOR", Token::Type::XOR)
+    .value("LOGAND", Token::Type::LOGAND)
+    .value("LOGOR", Token::Type::LOGOR)
+    .value("EQ", Token::Type::EQ)
+    .value("LESS", Token::Type::LESS)
+    .value("GREATER", Token::Type::GREATER)
+    .value("LESSEQ", Token::Type::LESSEQ)
+    .value("GREATEREQ", Token::Type::GREATEREQ)
+    .value("PLUS_ASSIGN", Token::Type::PLUS_ASSIGN)
+    .value("MINUS_ASSIGN", Token::Type::MINUS_ASSIGN)
+    .value("INCREMENT", Token::Type::INCREMENT)
+    .value("DECREMENT", Token::Type::DECREMENT)
+    .value("NOTEQ", Token::Type::NOTEQ)
+    .value("NOT", Token::Type::NOT)
+    .value("ARROW", Token::Type::ARROW)
+    .value("CAST_SYMBOL", Token::Type::CAST_SYMBOL)
+    .value("FUNC", Token::Type::FUNC)
+    .value("GLOBAL", Token::Type::GLOBAL)
+    .value("RETURN", Token::Type::RETURN)
+    .value("VAR", Token::Type::VAR)
+    .value("ASM", Token::Type::ASM)
+    .value("BRANCH", Token::Type::BRANCH)
+    .value("LOOP", Token::Type::LOOP)
+    .value("BREAK", Token::Type::BREAK)
+    .value("CONTINUE", Token::Type::CONTINUE)
+    .value("TRY", Token::Type::TRY)
+    .value("ELSE", Token::Type::ELSE)
+    .value("FINALLY", Token::Type::FINALLY)
+    .value("TRUE_LIT", Token::Type::TRUE_LIT)
+    .value("FALSE_LIT", Token::Type::FALSE_LIT)
+    .value("NULL_LIT", Token::Type::NULL_LIT)
+    .value("GUARD", Token::Type::GUARD)
+    .value("SIZEOF", Token::Type::SIZEOF)
     .export_values();  
   
   py::class_<Token>(module, "Token")
-    .def(py::init<std::string, Token::Type, std::string, TokenRange, TokenSrcId>())
-    .def_readonly("value", &Token::value)
+    .def(py::init([](std::string value, Token::Type type, std::string name, TokenRange range, TokenSrcId srcId) {
+      // Only the value and type of a built token are meaningful
+      return Token{type, srcId, 0, 0, global_isc->getSymbols().intern(value)};
+    }))
+    .def_property_readonly("value", &Token::value)
     .def_readonly("type", &Token::type)
-    .def_readonly("name", &Token::name)
-    .def_readonly("range", &Token::range)
+    .def_property_readonly("name", &Token::name)
+    .def_property_readonly("range", &Token::range)
     .def_readonly("srcId", &Token::srcId);
 
   py::class_<TokenStream>(module, "TokenStream")
     .def(py::init<>())
-    .def("pop", &TokenStream::pop);
+    .def("pop", &TokenStream::pop, py::return_value_policy::reference_internal);
 
 
   py::class_<WindLexer>(module, "WindLexer")
-    .def(py::init<const char *>())
+    .def(py::init([](std::string data) {
+      SourceBuffer *source = new SourceBuffer(data);
+      return new WindLexer(source->view());
+    }))
     .def("get", &WindLexer::get);
 
   module.def("TokenizeFile", &TokenizeFile, "A function that tokenizes a file");
@@ -0,0 +1,283 @@
+/**
+ * @file frontend.cpp
+ * @brief Lexer and parser throughput benchmark (windbench).
+ *
+ * Generates synthetic sources, then times TokenizeFile, WindParser::parse on
+ * the lexed tokens and the streaming pipeline used by the driver. Results
+ * are printed as JSON so runs on two commits can be diffed.
+ */
+
+#include <wind/processing/lexer.h>
+#include <wind/processing/parser.h>
+#include <wind/bridge/arena.h>
+#include <wind/common/memory.h>
+#include <wind/isc/isc.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+struct Measure {
+  double seconds = 0;
+  uint64_t allocs = 0;
+  uint64_t alloc_bytes = 0;
+};
+
+struct Result {
+  std::string kind;
+  size_t bytes = 0;
+  size_t tokens = 0;
+  Measure lex, parse, stream;
+};
+
+typedef std::function<std::string(size_t)> Generator;
+
+/**
+ * @brief Many small functions with locals, branches and calls.
+ */
+static std::string GenFunctions(size_t size) {
+  std::string out;
+  size_t funcs = 0;
+  while (out.size() < size) {
+    std::string n = std::to_string(funcs);
+    out += "func f_" + n + "(a: int, b: int): int {\n"
+           "    var x: int = a + " + std::to_string(funcs % 97) + ";\n"
+           "    branch [\n"
+           "        x > b: x = x - b;\n"
+           "        else: x = x + b;\n"
+           "    ]\n"
+           "    return x * 3;\n"
+           "}\n\n";
+    funcs++;
+  }
+  out += "func main(): int {\n    return f_0(1, 2);\n}\n";
+  return out;
+}
+
+/**
+ * @brief Functions returning deeply nested arithmetic.
+ */
+static std::string GenExpressions(size_t size) {
+  const int depth = 48;
+  std::string out;
+  size_t funcs = 0;
+  while (out.size() < size) {
+    std::string expr = "a";
+    for (int i = 0; i < depth; i++) {
+      const char *op = (i % 3 == 0) ? " + " : (i % 3 == 1) ? " * " : " - ";
+      expr = "(" + expr + op + (i % 2 ? "b" : std::to_string(i)) + ")";
+    }
+    out += "func e_" + std::to_string(funcs) + "(a: int, b: int): int {\n"
+           "    return " + expr + ";\n"
+           "}\n\n";
+    funcs++;
+  }
+  out += "func main(): int {\n    return e_0(1, 2);\n}\n";
+  return out;
+}
+
+/**
+ * @brief A long table of global string constants.
+ */
+static std::string GenStrings(size_t size) {
+  std::string out;
+  size_t count = 0;
+  while (out.size() < size) {
+    std::string text;
+    for (size_t i = 0; i < 4 + count % 13; i++) {
+      text += "lorem ipsum dolor sit amet " + std::to_string(count * 31 + i) + " ";
+    }
+    out += "global s_" + std::to_string(count) + ": ptr<char> = \"" + text + "\\n\";\n";
+    count++;
+  }
+  out += "func main(): int {\n    return 0;\n}\n";
+  return out;
+}
+
+/**
+ * @brief Runs a step and charges its time and allocations to a measure.
+ * @param phase The memory phase the step allocates in.
+ * @param step The step to run.
+ * @return The measure of this run.
+ */
+static Measure Run(const char *phase, const std::function<void()> &step) {
+  int id = MemoryPhaseId(phase);
+  uint64_t count0, bytes0, count1, bytes1;
+  MemoryPhaseUsage(id, count0, bytes0);
+  auto start = std::chrono::steady_clock::now();
+  step();
+  auto end = std::chrono::steady_clock::now();
+  MemoryPhaseUsage(id, count1, bytes1);
+  Measure m;
+  m.seconds = std::chrono::duration<double>(end - start).count();
+  m.allocs = count1 - count0;
+  m.alloc_bytes = bytes1 - bytes0;
+  return m;
+}
+
+/**
+ * @brief Keeps the fastest of two runs.
+ */
+static void Best(Measure &best, const Measure &run, bool first) {
+  if (first || run.seconds < best.seconds) {
+    best = run;
+  }
+}
+
+/**
+ * @brief Benchmarks one generated source.
+ * @param kind The name of the source kind.
+ * @param path Where the source was written.
+ * @param runs The number of runs, the fastest is kept.
+ * @param jobs The threads parsing function bodies.
+ */
+static Result Bench(const std::string &kind, const std::string &path, int runs, unsigned jobs) {
+  Result res;
+  res.kind = kind;
+  res.bytes = std::filesystem::file_size(path);
+  for (int r = 0; r < runs; r++) {
+    InitISC();
+    WindLexer *lexer = nullptr;
+    Best(res.lex, Run("lex", [&]() {
+      lexer = TokenizeFile(path.c_str());
+    }), r == 0);
+    if (!lexer) {
+      throw std::runtime_error("Could not lex " + path);
+    }
+    res.tokens = lexer->get()->getVec().size();
+    {
+      ASTArena arena;
+      ASTArena::Scope scope(&arena);
+      Best(res.parse, Run("parse", [&]() {
+        WindParser parser(lexer->get(), path);
+        parser.setJobs(jobs);
+        parser.parse();
+      }), r == 0);
+    }
+
+    // Lexing happens inside the parse span when streaming
+    InitISC();
+    {
+      ASTArena arena;
+      ASTArena::Scope scope(&arena);
+      Best(res.stream, Run("parse", [&]() {
+        WindLexer *streamed = StreamFile(path.c_str());
+        WindParser parser(streamed->get(), path);
+        parser.setJobs(jobs);
+        parser.parse();
+      }), r == 0);
+    }
+  }
+  return res;
+}
+
+/**
+ * @brief Writes a measure as a JSON object.
+ */
+static void EmitMeasure(std::ostream &out, const char *name, const Measure &m, const Result &res) {
+  double secs = std::max(m.seconds, 1e-9);
+  char buf[512];
+  snprintf(buf, sizeof(buf),
+    "\"%s\": {\"seconds\": %.6f, \"mb_per_s\": %.3f, \"tokens_per_s\": %.0f, "
+    "\"allocs\": %lu, \"alloc_bytes\": %lu}",
+    name, m.seconds, res.bytes / secs / (1 << 20), res.tokens / secs,
+    (unsigned long)m.allocs, (unsigned long)m.alloc_bytes
+  );
+  out << buf;
+}
+
+/**
+ * @brief Writes all results as JSON.
+ */
+static void EmitJSON(std::ostream &out, const std::string &label, int runs, unsigned jobs, const std::vector<Result> &results) {
+  out << "{\n  \"label\": \"" << label << "\",\n  \"runs\": " << runs << ",\n  \"jobs\": " << jobs << ",\n  \"benchmarks\": [\n";
+  for (size_t i = 0; i < results.size(); i++) {
+    const Result &res = results[i];
+    out << "    {\"kind\": \"" << res.kind << "\", \"bytes\": " << res.bytes
+        << ", \"tokens\": " << res.tokens << ",\n     ";
+    EmitMeasure(out, "lex", res.lex, res);
+    out << ",\n     ";
+    EmitMeasure(out, "parse", res.parse, res);
+    out << ",\n     ";
+    EmitMeasure(out, "stream", res.stream, res);
+    out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+  }
+  out << "  ]\n}\n";
+}
+
+static void Usage(const char *argv0) {
+  std::cerr << "Usage: " << argv0
+            << " [--size MiB] [--kind functions|expressions|strings|all]"
+               " [--runs N] [--jobs N] [--label name] [--out file.json]" << std::endl;
+  _Exit(1);
+}
+
+int main(int argc, char **argv) {
+  double size_mib = 1;
+  std::string kind = "all";
+  int runs = 3;
+  unsigned jobs = 1;
+  std::string label = "";
+  std::string out_path = "";
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (i + 1 >= argc) {
+      Usage(argv[0]);
+    }
+    if (arg == "--size") {
+      size_mib = std::stod(argv[++i]);
+    } else if (arg == "--kind") {
+      kind = argv[++i];
+    } else if (arg == "--runs") {
+      runs = std::max(1, std::stoi(argv[++i]));
+    } else if (arg == "--jobs") {
+      jobs = std::max(1, std::stoi(argv[++i]));
+    } else if (arg == "--label") {
+      label = argv[++i];
+    } else if (arg == "--out") {
+      out_path = argv[++i];
+    } else {
+      Usage(argv[0]);
+    }
+  }
+
+  std::vector<std::pair<std::string, Generator>> kinds = {
+    {"functions", GenFunctions},
+    {"expressions", GenExpressions},
+    {"strings", GenStrings},
+  };
+  EnableMemoryReport();
+  size_t size = (size_t)(size_mib * (1 << 20));
+  std::string dir = std::filesystem::temp_directory_path().string();
+  std::vector<Result> results;
+  for (auto &k : kinds) {
+    if (kind != "all" && kind != k.first) {
+      continue;
+    }
+    std::string path = dir + "/windbench_" + std::to_string(getpid()) + "_" + k.first + ".w";
+    {
+      std::ofstream file(path);
+      file << k.second(size);
+    }
+    results.push_back(Bench(k.first, path, runs, jobs));
+    std::filesystem::remove(path);
+  }
+  if (results.empty()) {
+    Usage(argv[0]);
+  }
+
+  if (out_path.empty()) {
+    EmitJSON(std::cout, label, runs, jobs, results);
+  } else {
+    std::ofstream out(out_path);
+    EmitJSON(out, label, runs, jobs, results);
+  }
+  return 0;
+}
@@ -0,0 +1,97 @@
+import subprocess,time,os,sys
+
+WIND_PATH = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..", "build", "windc")
+OUTPUT_PATH = os.path.join(os.path.dirname(os.path.abspath(__file__)), "build/")
+if (not os.path.exists(OUTPUT_PATH)):
+    os.makedirs(OUTPUT_PATH)
+
+# Source sizes in bytes, the first one already exceeds the old 16-bit offsets
+SIZES = [1 << 16, 1 << 18, 1 << 20, 1 << 22]
+# The largest size must keep at least this fraction of the smallest size's throughput
+MIN_SCALING = 0.5
+
+
+def hrtd(diff):
+    if diff < 1e-6:
+        # Nanoseconds
+        return f"{diff * 1e9:.3f} ns"
+    elif diff < 1e-3:
+        # Microseconds
+        return f"{diff * 1e6:.3f} µs"
+    elif diff < 1:
+        # Milliseconds
+        return f"{diff * 1e3:.3f} ms"
+    else:
+        # Seconds
+        return f"{diff:.6f} s"
+
+def generate(path, size):
+    funcs = 0
+    written = 0
+    with open(path, "w") as f:
+        while written < size:
+            chunk = (
+                f"func f_{funcs}(a: int, b: int): int {{\n"
+                f"    var x: int = a + {funcs % 97};\n"
+                f"    branch [\n"
+                f"        x > b: x = x - b;\n"
+                f"        else: x = x + b;\n"
+                f"    ]\n"
+                f"    return x * 3;\n"
+                f"}}\n\n"
+            )
+            f.write(chunk)
+            written += len(chunk)
+            funcs += 1
+        f.write("func main(): int {\n    return f_0(1, 2);\n}\n")
+    return funcs
+
+def phases(report):
+    # Parses the "wall cpu phase" rows printed by -ftime-report
+    res = {}
+    for line in report.splitlines():
+        cols = line.split()
+        if len(cols) == 3:
+            try:
+                res[cols[2]] = float(cols[0]) / 1e3
+            except ValueError:
+                pass
+    return res
+
+def bench(size):
+    path = os.path.join(OUTPUT_PATH, f"large_{size}.w")
+    funcs = generate(path, size)
+    size = os.path.getsize(path)
+    start_time = time.time()
+    res = subprocess.run(
+        [WIND_PATH, path, "-ss", "-ftime-report"],
+        stdout=subprocess.DEVNULL,
+        stderr=subprocess.PIPE,
+        text=True
+    )
+    total = time.time() - start_time
+    if res.returncode != 0:
+        print(res.stderr)
+        raise Exception(f"Compilation of {size} bytes failed")
+    times = phases(res.stderr)
+    front = times.get("lex", 0) + times.get("parse", 0)
+    return size, funcs, front, total
+
+def main():
+    if (not os.path.exists(WIND_PATH)):
+        raise Exception(f"windc not found at {WIND_PATH}")
+    rows = []
+    print(f"{'bytes':>10} {'funcs':>7} {'lex+parse':>12} {'MB/s':>8} {'total':>12}")
+    for size in SIZES:
+        size, funcs, front, total = bench(size)
+        mbps = size / max(front, 1e-9) / (1 << 20)
+        rows.append(mbps)
+        print(f"{size:>10} {funcs:>7} {hrtd(front):>12} {mbps:>8.2f} {hrtd(total):>12}")
+    scaling = rows[-1] / rows[0]
+    print(f"Throughput scaling (largest / smallest): {scaling:.2f}")
+    if scaling < MIN_SCALING:
+        print("Frontend throughput degrades with source size")
+        sys.exit(1)
+
+if __name__ == "__main__":
+    main()
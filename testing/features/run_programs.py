@@ -0,0 +1,83 @@
+import os, subprocess, sys, tempfile
+
+# Compiles every program of tests/programs in each mode and checks that it
+# prints and returns the same as when assembled with as.
+# Usage: run_programs.py [path/to/windc]
+WIND_PATH = sys.argv[1] if len(sys.argv) > 1 else os.path.join(
+    os.path.dirname(os.path.abspath(__file__)), "..", "..", "build", "windc"
+)
+PROGRAMS_PATH = os.path.join(os.path.dirname(os.path.abspath(__file__)), "tests", "programs")
+
+
+def run(cmd, env=None):
+    # Line buffered, or the output of the program is lost when piped
+    res = subprocess.run(
+        ["stdbuf", "-oL"]+cmd,
+        stdout=subprocess.PIPE,
+        stderr=subprocess.PIPE,
+        text=True,
+        env=env
+    )
+    return res.returncode, res.stdout
+
+
+def execStack(exe):
+    # GNU_STACK flags, the last field before the alignment
+    res = subprocess.run(["readelf", "-lW", exe], stdout=subprocess.PIPE, text=True)
+    for line in res.stdout.splitlines():
+        if line.split()[:1] == ["GNU_STACK"]:
+            return "E" in line.split()[-2]
+    # No GNU_STACK header means an executable stack
+    return True
+
+
+def compileAndRun(src, out, flags, env=None):
+    res = subprocess.run(
+        [WIND_PATH, src, "-o", out]+flags,
+        stdout=subprocess.PIPE,
+        stderr=subprocess.PIPE,
+        text=True,
+        env=env
+    )
+    if res.returncode != 0:
+        return None, res.stderr
+    if execStack(out):
+        return None, "executable stack"
+    return run([out])
+
+
+def runModes(src, tmp):
+    out = os.path.join(tmp, "prog")
+    cache_env = dict(os.environ, WIND_CACHE_DIR=os.path.join(tmp, "cache"))
+    return [
+        ("Binary writer", lambda: compileAndRun(src, out, [])),
+        ("--run", lambda: run([WIND_PATH, "--run", src])),
+        ("-fcache miss", lambda: compileAndRun(src, out, ["-fcache"], cache_env)),
+        ("-fcache hit", lambda: compileAndRun(src, out, ["-fcache"], cache_env)),
+        # Other flags miss the object but reuse the interface images
+        ("-fcache images", lambda: compileAndRun(src, out, ["-fcache", "-fno-integrated-as"], cache_env)),
+    ]
+
+
+failed = 0
+print("[PROGRAM TESTS]")
+for name in sorted(os.listdir(PROGRAMS_PATH)):
+    if not name.endswith(".w"):
+        continue
+    src = os.path.join(PROGRAMS_PATH, name)
+    print(f"  [{name}]>")
+    with tempfile.TemporaryDirectory() as tmp:
+        expected = compileAndRun(src, os.path.join(tmp, "prog"), ["-fno-integrated-as"])
+        if expected[0] is None:
+            print(f"    * as: ❌\n{expected[1]}")
+            failed += 1
+            continue
+        for mode, test in runModes(src, tmp):
+            got = test()
+            if got == expected:
+                print(f"    * {mode}: ✅")
+            else:
+                print(f"    * {mode}: ❌ (expected {expected}, got {got})")
+                failed += 1
+
+sys.exit(1 if failed else 0)
@@ -55,5 +55,36 @@ LITERAL_TESTS = [
                 wtsuite.WAPI.Token(wtsuite.WAPI.TOKEN_TYPE.INTEGER, "2"),
             ]
         ]
+    },
+    {
+        "name": "Keyword Literal test",
+        "type": "lexer",
+        "args": [
+            # Contextual words (ptr, import, type) and prefixes stay identifiers
+            "func var global return branch else loop break continue try finally asm true false Null guard sizeof ptr import type funcs",
+            [
+                wtsuite.WAPI.Token(wtsuite.WAPI.TOKEN_TYPE.FUNC, "func"),
+                wtsuite.WAPI.Token(wtsuite.WAPI.TOKEN_TYPE.VAR, "var"),
+                wtsuite.WAPI.Token(wtsuite.WAPI.TOKEN_TYPE.GLOBAL, "global"),
+                wtsuite.WAPI.Token(wtsuite.WAPI.TOKEN_TYPE.RETURN, "return"),
+                wtsuite.WAPI.Token(wtsuite.WAPI.TOKEN_TYPE.BRANCH, "branch"),
+                wtsuite.WAPI.Token(wtsuite.WAPI.TOKEN_TYPE.ELSE, "else"),
+                wtsuite.WAPI.Token(wtsuite.WAPI.TOKEN_TYPE.LOOP, "loop"),
+                wtsuite.WAPI.Token(wtsuite.WAPI.TOKEN_TYPE.BREAK, "break"),
+                wtsuite.WAPI.Token(wtsuite.WAPI.TOKEN_TYPE.CONTINUE, "continue"),
+                wtsuite.WAPI.Token(wtsuite.WAPI.TOKEN_TYPE.TRY, "try"),
+                wtsuite.WAPI.Token(wtsuite.WAPI.TOKEN_TYPE.FINALLY, "finally"),
+                wtsuite.WAPI.Token(wtsuite.WAPI.TOKEN_TYPE.ASM, "asm"),
+                wtsuite.WAPI.Token(wtsuite.WAPI.TOKEN_TYPE.TRUE_LIT, "true"),
+                wtsuite.WAPI.Token(wtsuite.WAPI.TOKEN_TYPE.FALSE_LIT, "false"),
+                wtsuite.WAPI.Token(wtsuite.WAPI.TOKEN_TYPE.NULL_LIT, "Null"),
+                wtsuite.WAPI.Token(wtsuite.WAPI.TOKEN_TYPE.GUARD, "guard"),
+                wtsuite.WAPI.Token(wtsuite.WAPI.TOKEN_TYPE.SIZEOF, "sizeof"),
+                wtsuite.WAPI.Token(wtsuite.WAPI.TOKEN_TYPE.IDENTIFIER, "ptr"),
+                wtsuite.WAPI.Token(wtsuite.WAPI.TOKEN_TYPE.IDENTIFIER, "import"),
+                wtsuite.WAPI.Token(wtsuite.WAPI.TOKEN_TYPE.IDENTIFIER, "type"),
+                wtsuite.WAPI.Token(wtsuite.WAPI.TOKEN_TYPE.IDENTIFIER, "funcs"),
+            ]
+        ]
     }
 ]
\ No newline at end of file
@@ -0,0 +1,24 @@
+@include [
+  "#libc.wi"
+]
+
+func sum(n: long): long {
+  return n * (n + 1) / 2;
+}
+
+func mix(a: int, b: int, c: int): int {
+  return (a - b) * c;
+}
+
+func square(n: int): int {
+  return n * n;
+}
+
+func main(): int {
+  printf("%lld\n", sum(7));
+  printf("%d\n", mix(9, 4, 3));
+  printf("%d %d\n", 17 / 5, 17 % 5);
+  var s: int = square(12);
+  printf("%d\n", s + square(3));
+  return 0;
+}
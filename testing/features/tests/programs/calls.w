@@ -0,0 +1,22 @@
+@include [
+  "#libc.wi"
+]
+
+func shout(s: string, times: int): void {
+  var i: int = 0;
+  loop [i < times] {
+    printf("%s(%d) ", s, strlen(s));
+    i = i + 1;
+  }
+  puts("!");
+}
+
+func twice(n: int): int {
+  return n * 2;
+}
+
+func main(): int {
+  shout("wind", 2);
+  printf("%d\n", twice(twice(5)));
+  return 0;
+}
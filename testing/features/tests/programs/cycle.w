@@ -0,0 +1,6 @@
+@include "cycle/a.wi"
+
+func main(): int {
+  printf("%d %lld\n", abs(-42), labs(-7));
+  return 0;
+}
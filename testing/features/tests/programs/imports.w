@@ -0,0 +1,12 @@
+@include [
+  "#libc.wi"
+]
+@import [
+  "packages/twice"
+  "packages/base"
+]
+
+func main(): int {
+  printf("%d %d\n", base_val(), twice_val());
+  return 0;
+}
@@ -0,0 +1,31 @@
+@include [
+  "#libc.wi"
+]
+
+func diff_even(n: long): long {
+  var i: long = 0;
+  loop [n > 0] {
+    n = n - 1;
+    branch [
+      n % 2 == 0: i = n + i;
+      else: i = i - n;
+    ]
+    i = i + 1;
+  }
+  return i;
+}
+
+func main(): int {
+  var k: int = 0;
+  var odd: int = 0;
+  loop [true] {
+    k = k + 1;
+    branch [
+      k > 25: break;
+      k % 2 == 0: continue;
+    ]
+    odd = odd + k;
+  }
+  printf("%lld %d %d\n", diff_even(1000), k, odd);
+  return 3;
+}
@@ -0,0 +1,25 @@
+@include [
+  "#libc.wi"
+]
+
+func fill(buf: ptr<long>, n: int): void {
+  var i: int = 0;
+  loop [i < n] {
+    buf[i] = i * i;
+    i = i + 1;
+  }
+}
+
+func main(): int {
+  var buf: ptr<long> = guard![malloc(sizeof<long> * 16)];
+  fill(buf, 16);
+  var total: long = 0;
+  var i: int = 0;
+  loop [i < 16] {
+    total = total + buf[i];
+    i = i + 1;
+  }
+  printf("%lld %lld\n", buf[15], total);
+  free(buf);
+  return 0;
+}
@@ -0,0 +1,5 @@
+@include "base.wi"
+
+@pub func base_val(): int {
+  return 21;
+}
@@ -0,0 +1,6 @@
+@include "twice.wi"
+@import "../base"
+
+@pub func twice_val(): int {
+  return base_val() * 2;
+}